@@ -90,25 +90,30 @@
 #include "hardware.h"
 #include "hilt_cmd.h"
 #include "blade.h"
+#include "telemetry.h"
+#include "bench.h"
+
+// micros() at the moment hilt command capture was armed
+uint32_t boot_armed_us;
 
 // setup() performs one-time initialization steps
+//
+// when a blade is plugged into a hilt that is already on, a command can arrive almost immediately.
+// so hilt command capture is armed first and everything that isn't needed to respond to the hilt
+// is put off until after the first command; see hardware_deferred_setup().
 void setup() {
 
-  harware_setup();
   cmd_capture_setup();
-  blade_setup();
-  delay(100);
+  boot_armed_us = micros();
+  BENCH_MARK(BENCH_ARMED);
 
-  // serial output for debug purposes
-  #ifdef SERIAL_DEBUG_ENABLE
-    Serial.begin(115200);
-    delay(1000);
-    Serial.println(F("Ready!"));
-  #endif
+  harware_setup();
+  blade_setup();
 }
 
 // loop() is the main proram loop
 void loop() {
+  static bool setup_deferred = true;
 
   // get commands from the demo
   #ifdef ENABLE_DEMO
@@ -119,4 +124,17 @@ void loop() {
 
   // manage the blade
   blade_manager();
-}
+
+  // finish setting up the hardware once the first command has been handled, or the hilt has been
+  // quiet long enough that it probably isn't on
+  if (setup_deferred && (blade.cmd != 0 || millis() >= BOOT_DEFER_TIME)) {
+    setup_deferred = false;
+    hardware_deferred_setup();
+
+    DEBUG_EVENT(TELEMETRY_BOOT, TELEMETRY_BOOT_TIME(boot_armed_us));
+    DEBUG_EVENT(TELEMETRY_READY, 0);
+  }
+
+  // send any queued debug events out over serial
+  DEBUG_DRAIN();
+}
\ No newline at end of file
@@ -0,0 +1,120 @@
+/* battery.cpp
+ *
+ * the battery is read through a voltage divider on BATTERY_SENSE_PIN. the raw ADC value is
+ * converted to millivolts and smoothed with a simple moving average so a single noisy sample
+ * (or a sample taken just as the LEDs pull a lot of current) doesn't jerk the brightness around.
+ *
+ * WS2812B output drops as their supply voltage drops. to hide that, brightness is scaled by
+ * BATTERY_NOMINAL_MV / current voltage, so a blade tuned on a fresh battery looks the same on
+ * a tired one (until brightness runs out of headroom at 255).
+ */
+#include "battery.h"
+#include "config.h"
+#include "telemetry.h"
+
+#ifdef BATTERY_SENSE_PIN
+
+// smoothed battery voltage, in mV; 0 means no sample has been taken yet
+static uint16_t battery_avg_mv = 0;
+
+// rate the battery is draining, in 1/16ths of a mV per minute
+static uint16_t battery_drain_rate = 0;
+
+// prepare the ADC pin
+void battery_setup() {
+  pinMode(BATTERY_SENSE_PIN, INPUT);
+}
+
+// take a battery voltage sample if one is due.
+//
+// this is called by blade_manager() on passes where the LEDs were not updated and the blade is
+// idle or off. reading the ADC takes roughly 100us so it is also skipped while a command is
+// coming in from the hilt.
+void battery_sample() {
+  static uint32_t next_sample = 0;
+  static uint32_t window_start = 0;
+  static uint16_t window_start_mv = 0;
+  uint32_t mv;
+
+  #ifdef USE_DONT_SHOW
+    if (dont_show) {
+      return;
+    }
+  #endif
+
+  if (next_sample > millis()) {
+    return;
+  }
+  next_sample = millis() + BATTERY_SAMPLE_INTERVAL;
+
+  // hardware_deferred_setup() disables the ADC on AVRs to save power; only switch it on long
+  // enough to take this reading. the first conversion after enabling the ADC is thrown away.
+  #if defined(ADCSRA) && defined(ADEN)
+    ADCSRA |= (1 << ADEN);
+    analogRead(BATTERY_SENSE_PIN);
+  #elif defined(ADC0) && defined(ADC_ENABLE_bm)
+    ADC0.CTRLA |= ADC_ENABLE_bm;
+    analogRead(BATTERY_SENSE_PIN);
+  #endif
+
+  mv = ((uint32_t)analogRead(BATTERY_SENSE_PIN) * BATTERY_ADC_REF_MV * BATTERY_DIVIDER_RATIO) / 1023;
+
+  #if defined(ADCSRA) && defined(ADEN)
+    ADCSRA &= ~(1 << ADEN);
+  #elif defined(ADC0) && defined(ADC_ENABLE_bm)
+    ADC0.CTRLA &= ~ADC_ENABLE_bm;
+  #endif
+
+  // first sample seeds the average and the runtime window
+  if (battery_avg_mv == 0) {
+    battery_avg_mv = mv;
+    window_start = millis();
+    window_start_mv = mv;
+  } else {
+    battery_avg_mv = (int32_t)battery_avg_mv + (((int32_t)mv - (int32_t)battery_avg_mv) / 4);
+  }
+
+  // once a minute, fold the voltage drop over that minute into the drain rate
+  if ((millis() - window_start) >= 60000UL) {
+    uint16_t drop = (window_start_mv > battery_avg_mv) ? (window_start_mv - battery_avg_mv) : 0;
+    uint16_t rate = (uint32_t)drop * 16 * 60000UL / (millis() - window_start);
+
+    battery_drain_rate = (battery_drain_rate == 0) ? rate : (battery_drain_rate + (((int32_t)rate - (int32_t)battery_drain_rate) / 4));
+    window_start = millis();
+    window_start_mv = battery_avg_mv;
+  }
+
+  DEBUG_EVENT(TELEMETRY_BATTERY_MV, battery_avg_mv);
+  DEBUG_EVENT(TELEMETRY_BATTERY_RUNTIME, battery_runtime_min());
+}
+
+// the smoothed battery voltage, in mV
+uint16_t battery_mv() {
+  return battery_avg_mv;
+}
+
+// estimated minutes until the battery reaches BATTERY_EMPTY_MV; 0xFFFF if not yet known
+uint16_t battery_runtime_min() {
+  if (battery_drain_rate == 0) {
+    return 0xFFFF;
+  }
+  if (battery_avg_mv <= BATTERY_EMPTY_MV) {
+    return 0;
+  }
+  return ((uint32_t)(battery_avg_mv - BATTERY_EMPTY_MV) * 16) / battery_drain_rate;
+}
+
+// scale brightness up to make up for a battery that has sagged below BATTERY_NOMINAL_MV
+uint8_t battery_brightness(uint8_t brightness) {
+  uint32_t b;
+
+  if (battery_avg_mv == 0 || battery_avg_mv >= BATTERY_NOMINAL_MV) {
+    return brightness;
+  }
+
+  // never compensate below BATTERY_EMPTY_MV; a battery that low is better off dim
+  b = ((uint32_t)brightness * BATTERY_NOMINAL_MV) / ((battery_avg_mv > BATTERY_EMPTY_MV) ? battery_avg_mv : BATTERY_EMPTY_MV);
+  return (b > 255) ? 255 : b;
+}
+
+#endif
@@ -0,0 +1,28 @@
+/* battery.h
+ * Optional battery (supply) voltage sensing.
+ *
+ * the supply voltage is sampled at a low duty cycle, only while the blade is idle or off
+ * and never while a command is being read from the hilt or the LEDs are being updated.
+ * the readings are used to raise the brightness of the blade as the battery sags so the
+ * blade doesn't visibly dim, and to keep a rough estimate of how much runtime is left.
+ *
+ * if BATTERY_SENSE_PIN is not defined then all of this compiles away to nothing. the host build
+ * (see extras/host) scripts the voltage on the pin; battery.sh there checks the compensation and
+ * when samples are taken.
+ */
+#pragma once
+
+#include "hardware.h"
+
+#ifdef BATTERY_SENSE_PIN
+
+  void battery_setup();
+  void battery_sample();
+  uint16_t battery_mv();
+  uint16_t battery_runtime_min();
+  uint8_t battery_brightness(uint8_t brightness);
+
+  #define BATTERY_BRIGHTNESS(b)   battery_brightness(b)   // brightness b, compensated for a sagging battery
+#else
+  #define BATTERY_BRIGHTNESS(b)   (b)
+#endif
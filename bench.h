@@ -0,0 +1,35 @@
+/* bench.h
+ * Markers for cycle benchmarking under a simulator.
+ *
+ * with ENABLE_BENCHMARK defined, interesting points in the code write a marker value to the
+ * GPIOR0 register. GPIOR0 does nothing on its own and costs a single cycle to write, but a
+ * simulator (see extras/simavr_bench) can watch it and note the cycle count of every write.
+ * HOST_BUILD (see extras/host) hands every marker to the host simulator instead.
+ *
+ * without ENABLE_BENCHMARK, or on an MCU without GPIOR0, the markers compile away to nothing.
+ */
+#pragma once
+
+#include "hardware.h"
+
+#if defined(ENABLE_BENCHMARK) && (defined(GPIOR0) || defined(HOST_BUILD))
+  #define BENCH_MARK(m)     GPIOR0 = (m)
+#else
+  #define BENCH_MARK(m)
+#endif
+
+// marker values; keep these in sync with extras/simavr_bench/bench.c
+#define BENCH_END           0x00      // end of a blade_manager() pass
+#define BENCH_MANAGER       0x40      // start of a blade_manager() pass; OR'd with the blade state
+#define BENCH_SHOW_BEGIN    0x80      // about to call SHOW_LEDS()
+#define BENCH_SHOW_END      0x81      // SHOW_LEDS() has returned
+#define BENCH_CMD_PERIOD    0x90      // read_cmd() picked up a new pulse period
+#define BENCH_CMD_DECODED   0x91      // read_cmd() decoded a full command
+#define BENCH_ARMED         0x92      // setup() has armed hilt command capture
+#define BENCH_NOISE_BEGIN   0xA0      // about to draw an unstable blade frame with noise_frame()
+#define BENCH_NOISE_END     0xA1      // noise_frame() has returned
+#define BENCH_TARGET_BEGIN  0xA2      // about to work out how many LEDs an ignition or extinguish has reached
+#define BENCH_TARGET_END    0xA3      // done; curve_leds() with IGNITION_CURVES, a division without
+#define BENCH_HUE_BEGIN     0xA4      // about to convert a hue to a color with color_by_hsv()
+#define BENCH_HUE_END       0xA5      // color_by_hsv() is done
+#define BENCH_PATTERN       0xB0      // pattern_command() recognized a pattern; OR'd with the pattern (see pattern.h)
@@ -6,10 +6,226 @@
 #include "blade_color_table.h"
 #include "config.h"
 #include "effects.h"
+#include "power.h"
+#include "battery.h"
+#include "snapshot.h"
+#include "bench.h"
+#include "telemetry.h"
+#include "calibration.h"
+#include "clip.h"
+#include "noise.h"
+#include "clash.h"
+#include "pattern.h"
+#include "curve.h"
+#include "profile.h"
+#include "journal.h"
+#include "blade_geometry.h"
 
 // global blade properties object
 blade_t blade;
 
+// states in which every pixel holds the blade color, so the frame tick can redraw the whole strip
+#define BLADE_FULLY_LIT(s)    ((s) == BLADE_IDLE || (s) == BLADE_FLICKER_LOW || (s) == BLADE_FLICKER_HIGH)
+
+// unstable blade
+//
+// with UNSTABLE_BLADE, a lightsaber given EFFECT_UNSTABLE in stock_blade_config.cpp has every
+// pixel dimmed by its own, constantly changing, amount while it's fully lit (see noise.h). the
+// frame tick redraws it every FRAME_TIME ms. the power governor goes on tracking the undimmed
+// blade color, which is never less than what is actually shown.
+#ifdef UNSTABLE_BLADE
+  #define BLADE_UNSTABLE()    (blade.current_brightness_effect == EFFECT_UNSTABLE)
+
+  // true while the strip holds a noise frame rather than the plain blade color
+  static bool unsettled = false;
+#else
+  #define BLADE_UNSTABLE()    false
+#endif
+
+// extinguish
+//
+// LEDs go dark one at a time from the tip back towards the hilt. only the LEDs that have gone dark
+// since the last pass are written; in MIRROR_MODE that's one span on each half of the strip (see
+// blade_geometry.h).
+//
+// with EXTINGUISH_TAIL_LEN, the LEDs don't go straight from the blade color to dark. the last
+// EXTINGUISH_TAIL_LEN LEDs before the dark part of the blade are a tail that fades from the blade
+// color down to nearly dark, and it follows the dark part back to the hilt. the tail is counted as
+// part of the distance covered, so the blade is still fully dark exactly extinguish_time ms after
+// the extinguish begins. each pass redraws only the tail and whatever has gone dark behind it.
+#ifdef EXTINGUISH_TAIL_LEN
+  #define EXTINGUISH_END        (TARGET_MAX + EXTINGUISH_TAIL_LEN)
+  #define EXTINGUISH_TAIL_STEP  (256 / EXTINGUISH_TAIL_LEN)                 // brightness, out of 256, between one tail LED and the next
+
+  // of the first n LEDs from the tip that have started to fade, how many are dark
+  #define EXTINGUISH_DARK(n)    (((n) > EXTINGUISH_TAIL_LEN) ? ((n) - EXTINGUISH_TAIL_LEN) : 0)
+#else
+  #define EXTINGUISH_END        TARGET_MAX
+#endif
+
+// turn off LEDs 'from' up to 'to', counting in from the tip
+static void blade_extinguish_span(uint16_t from, uint16_t to) {
+  if (to <= from) {
+    return;
+  }
+
+  POWER_SPAN(blade.color, RGB_BLADE_OFF, (to - from) * Blade::copies);
+  Blade::fill_tip(RGB_BLADE_OFF, from, to);
+}
+
+#ifdef EXTINGUISH_TAIL_LEN
+  // draw the tail, given how many LEDs in from the tip have started to fade. the LED nearest the
+  // tip is the dimmest and each one back towards the hilt is EXTINGUISH_TAIL_STEP brighter
+  static void blade_extinguish_tail(uint16_t n) {
+    uint16_t i = EXTINGUISH_DARK(n);
+    uint16_t end = (n < TARGET_MAX) ? n : TARGET_MAX;
+    uint16_t level = (i + EXTINGUISH_TAIL_LEN + 1 - n) * EXTINGUISH_TAIL_STEP;
+    LED_RGB_TYPE c;
+
+    for (; i < end; i++) {
+      c = LED_RGB((LED_RGB_R(blade.color) * level) >> 8, (LED_RGB_G(blade.color) * level) >> 8, (LED_RGB_B(blade.color) * level) >> 8);
+      Blade::set(Blade::tip(i), c);
+      level += EXTINGUISH_TAIL_STEP;
+    }
+  }
+#endif
+
+// true while a localized clash flash is showing (see clash.h)
+#ifdef CLASH_FLASH
+  #define BLADE_FLASHING()    clash_active()
+
+  // somewhere along the blade; the low bits of micros() are as good as random for when a clash lands
+  #define BLADE_RANDOM_SPOT() ((((micros() >> 2) & 0xFF) * TARGET_MAX) >> 8)
+
+  // where the last clash flash hit
+  static uint16_t clash_center = 0;
+#else
+  #define BLADE_FLASHING()    false
+#endif
+
+// the pattern, if any, the last command completed (see pattern.h)
+#ifdef COMMAND_PATTERNS
+  static uint8_t clash_pattern = PATTERN_NONE;
+#endif
+
+// color crossfade
+//
+// with COLOR_CROSSFADE_TIME, a new color in the color wheel cycle (including the momentary white
+// picked by a clash) is faded into rather than cut to. only blade.color is moved along the fade;
+// the frame tick then fills the strip with it, so each step costs 3 blends and a fill no matter
+// how many LEDs there are. the fade position is the time since the fade began, multiplied by a
+// reciprocal of COLOR_CROSSFADE_TIME worked out by the compiler, so a late frame still lands on
+// the right color.
+#ifdef COLOR_CROSSFADE_TIME
+  #define CROSSFADE_RECIPROCAL  ((256UL << 16) / COLOR_CROSSFADE_TIME)   // fade position per ms, 16.16 fixed point
+
+  static LED_RGB_TYPE fade_from;
+  static LED_RGB_TYPE fade_to;
+  static uint32_t fade_start;
+  static bool fading = false;
+
+  // blend two channel values; pos 0 is all of a, 255 is almost all of b.
+  // the weights add up to 256, so the sum can't go over 255 * 256
+  static uint8_t blade_blend(uint8_t a, uint8_t b, uint8_t pos) {
+    return ((uint16_t)a * (256 - pos) + (uint16_t)b * pos) >> 8;
+  }
+
+  // fade from the given color to the one currently in blade.color
+  static void blade_crossfade(LED_RGB_TYPE from) {
+    fade_from = from;
+    fade_to = blade.color;
+    fade_start = millis();
+    fading = true;
+    blade.color = from;
+  }
+
+  // move blade.color along the fade; returns true if it changed
+  static bool blade_crossfade_step() {
+    uint32_t elapsed;
+    uint8_t pos;
+
+    if (!fading) {
+      return false;
+    }
+
+    elapsed = millis() - fade_start;
+    if (elapsed >= COLOR_CROSSFADE_TIME) {
+      fading = false;
+      blade.color = fade_to;
+    } else {
+      pos = (elapsed * CROSSFADE_RECIPROCAL) >> 16;
+      blade.color = LED_RGB(
+        blade_blend(LED_RGB_R(fade_from), LED_RGB_R(fade_to), pos),
+        blade_blend(LED_RGB_G(fade_from), LED_RGB_G(fade_to), pos),
+        blade_blend(LED_RGB_B(fade_from), LED_RGB_B(fade_to), pos)
+      );
+    }
+    return true;
+  }
+#endif
+
+// temporal dithering
+//
+// brightness is normally applied by the LED library as the strip is shown, and each channel is
+// cut down to 8 bits as it is. a dim color like RGB_BLADE_DARK_PURPLE (16, 0, 32) at a flicker
+// brightness of 20 comes out as (1, 0, 2), and flicker steps between levels that far apart show
+// as banding.
+//
+// with TEMPORAL_DITHER, while the blade is fully lit, brightness is folded into the color instead.
+// each channel is worked out to 16 bits (8 bits of color, 8 bits of fraction) and each pixel adds
+// its own offset to the fraction before it's cut back to 8 bits. the offsets are an ordered dither
+// pattern that moves along the strip one pixel a frame, so at any moment the right share of pixels
+// is a level up, spread out along the blade, and over a few frames each pixel averages out to its
+// exact value. one offset for the whole strip would step every pixel up and down together, and a
+// fraction of 1/8 would then strobe the whole blade at 1/8th the frame rate. the strip is refilled
+// and shown every FRAME_TIME ms to make that work.
+#ifdef TEMPORAL_DITHER
+  // true while the strip holds dithered colors and the library brightness is at 255
+  static bool dithering = false;
+
+  // the bits of n in reverse order; counting up through these, any run of 2, 4, 8, ... values
+  // is spread evenly over 0-255
+  static uint8_t dither_offset(uint8_t n) {
+    n = (n >> 4) | (n << 4);
+    n = ((n & 0xCC) >> 2) | ((n & 0x33) << 2);
+    return ((n & 0xAA) >> 1) | ((n & 0x55) << 1);
+  }
+
+  // fill the strip with the blade color, at the blade's brightness, for this frame
+  static void blade_dither_frame() {
+    static uint8_t frame = 0;
+    uint16_t scale;
+    uint16_t r, g, b;
+    uint16_t i;
+    uint8_t d;
+
+    // the brightness the library would have used; +1 so full brightness is a scale of 256
+    scale = POWER_BRIGHTNESS(BATTERY_BRIGHTNESS(blade.brightness)) + 1;
+
+    // 255 * 256 + 255 just fits in 16 bits
+    r = LED_RGB_R(blade.color) * scale;
+    g = LED_RGB_G(blade.color) * scale;
+    b = LED_RGB_B(blade.color) * scale;
+
+    // the power governor keeps tracking the undimmed blade color, so POWER_FILL() is not used here
+    for (i = 0; i < TARGET_MAX; i++) {
+      d = dither_offset(i + frame);
+      Blade::set(i, LED_RGB((uint16_t)(r + d) >> 8, (uint16_t)(g + d) >> 8, (uint16_t)(b + d) >> 8));
+    }
+    frame++;
+
+    LED_OBJ.setBrightness(255);
+    dithering = true;
+  }
+
+  // put the undimmed color back in the strip and hand brightness back to the LED library
+  static void blade_dither_stop() {
+    dithering = false;
+    LED_FILL(blade.color);
+    blade_set_brightness(blade.brightness);
+  }
+#endif
+
 // blade_manager() takes care of changing the colors of the blade
 //
 // if you're looking to add custom blade behaviors then this function is likely
@@ -19,9 +235,26 @@ void blade_manager() {
   static uint32_t animate_step = 0;
   static uint32_t last_extinguish = 0;
   static blade_state_t last_state = BLADE_UNINITIALIZED;
-  static uint8_t wheel_index = 0;
+  #if defined(TEMPORAL_DITHER) || defined(COLOR_CROSSFADE_TIME) || defined(UNSTABLE_BLADE) || defined(CLASH_FLASH)
+    static uint32_t next_frame = 0;
+  #endif
+  #ifdef ENABLE_CLIPS
+    static bool playing_clip = false;
+  #endif
+  #ifdef IGNITION_CURVES
+    static uint32_t animate_rate;     // see curve_rate(); set when an ignition or extinguish starts so the passes in between don't divide
+  #endif
   uint16_t target;
   bool update_blade = false;
+  #if defined(COLOR_CROSSFADE_TIME) || defined(CLASH_FLASH)
+    LED_RGB_TYPE from;
+  #endif
+  #ifdef CLASH_FLASH
+    blade_state_t previous_state;
+    uint8_t shift;
+  #endif
+
+  BENCH_MARK(BENCH_MANAGER | blade.state);
 
   //
   // TODO: DONT_SHOW mod, make update_blade static and unset it if SHOW_LEDS() is called successfully.
@@ -43,6 +276,10 @@ void blade_manager() {
     // immediately set hilt_cmd to zero so we know we've processed it
     hilt_cmd = 0;
 
+    #ifdef WAKE_STATS
+      wake_stats_command();
+    #endif
+
     // call function that processes the command received from the hilt
     blade_process_command();
   }
@@ -54,8 +291,45 @@ void blade_manager() {
   // blade state is handled.
   //
   if (last_state != blade.state) {
+    #ifdef CLASH_FLASH
+      previous_state = last_state;
+    #endif
     last_state = blade.state;
 
+    // DEBUG: log the state change
+    DEBUG_EVENT(TELEMETRY_STATE, blade.state);
+
+    // a fade only runs while the blade is fully lit; anything else skips straight to its end
+    #ifdef COLOR_CROSSFADE_TIME
+      if (fading && !BLADE_FULLY_LIT(blade.state)) {
+        fading = false;
+        blade.color = fade_to;
+      }
+    #endif
+
+    // leaving a dithered state; put the undimmed color back in the strip and hand brightness back
+    // to the LED library before the new state starts drawing
+    #ifdef TEMPORAL_DITHER
+      if (dithering && !BLADE_FULLY_LIT(blade.state)) {
+        blade_dither_stop();
+      }
+    #endif
+
+    // same for a noise frame; an extinguish or clash shouldn't start from a frozen frame of noise
+    #ifdef UNSTABLE_BLADE
+      if (unsettled && !BLADE_FULLY_LIT(blade.state)) {
+        unsettled = false;
+        LED_FILL(blade.color);
+      }
+    #endif
+
+    // a flash only shows on a fully lit blade; a clash on top of one adds to it (see BLADE_CLASH below)
+    #ifdef CLASH_FLASH
+      if (clash_active() && !BLADE_FULLY_LIT(blade.state) && blade.state != BLADE_CLASH) {
+        clash_end(blade.color);
+      }
+    #endif
+
     // do not allow a refresh, on, or idle state change to disrupt any potential ongoing effects
     switch (blade.state) {
       case BLADE_REFRESH:
@@ -72,15 +346,15 @@ void blade_manager() {
 
       // the blade is off. disable any running animations and shut the LEDs off
       case BLADE_OFF:
-        #ifdef SERIAL_DEBUG_ENABLE
-          Serial.println(F("Blade State Change: BLADE_OFF"));
-        #endif
+        // DEBUG: send the command decoder statistics along with the state change
+        DEBUG_STATS();
 
         // set the point when the blade controller should go to sleep
         next_step = millis() + SLEEP_AFTER;
 
         // turn the LEDs off
         LED_OBJ.clear();
+        POWER_CLEAR();
         SHOW_LEDS();    // unnecessary since the next step is to cut power to the LEDs
                         // i'm leaving this line in because my test environment will sometimes
                         // involve keeping the LEDs always powered
@@ -92,14 +366,15 @@ void blade_manager() {
         #ifdef LED_PWR_SWITCH_PIN
           led_power_off();
         #endif
+
+        // now that the blade is dark, save its color mode if it changed while it was lit
+        #ifdef REMEMBER_COLOR
+          journal_save();
+        #endif
         break;
 
       // the blade is powering on
       case BLADE_IGNITING:
-        #ifdef SERIAL_DEBUG_ENABLE
-          Serial.println(F("Blade State Change: BLADE_IGNITING"));
-        #endif
-
         // switch color modes if blade was off for less than COLOR_MODE_CHANGE_TIME
         if (last_extinguish > 0 && (millis() - last_extinguish) < COLOR_MODE_CHANGE_TIME) {
 
@@ -107,64 +382,31 @@ void blade_manager() {
           switch (blade.color_mode) {
 
             case COLOR_MODE_STOCK:
-              #ifdef SERIAL_DEBUG_ENABLE
-                Serial.println(F("New Color Mode: COLOR_MODE_WHEEL_CYCLE"));
-              #endif
-
               blade.color_mode = COLOR_MODE_WHEEL_CYCLE;
               break;
 
             case COLOR_MODE_WHEEL_CYCLE:
-              #ifdef SERIAL_DEBUG_ENABLE
-                Serial.println(F("New Color Mode: COLOR_MODE_WHEEL_HOLD"));
-              #endif
-
               blade.color_mode = COLOR_MODE_WHEEL_HOLD;
               break;
 
             case COLOR_MODE_WHEEL_CYCLE_WHITE:
-              #ifdef SERIAL_DEBUG_ENABLE
-                Serial.println(F("New Color Mode: COLOR_MODE_WHEEL_HOLD"));
-              #endif
-
               blade.color_mode = COLOR_MODE_WHEEL_HOLD_WHITE;
               break;
 
             case COLOR_MODE_WHEEL_HOLD:
             case COLOR_MODE_WHEEL_HOLD_WHITE:
             default:
-              #ifdef SERIAL_DEBUG_ENABLE
-                Serial.println(F("New Color Mode: COLOR_MODE_STOCK"));
-              #endif
-
               blade.color_mode = COLOR_MODE_STOCK;
               break;              
           }
+          DEBUG_EVENT(TELEMETRY_COLOR_MODE, blade.color_mode);
         }
 
         // set the color and clash color of the blade based on the current color mode
-        switch (blade.color_mode) {
-
-          // wheel color is based on wheel_index
-          case COLOR_MODE_WHEEL_CYCLE:
-          case COLOR_MODE_WHEEL_HOLD:
-            blade.color = color_by_wheel(wheel_index);
-            blade.color_clash = RGB_BLADE_CLASH_WHITE;   // TODO: intelligently pick a clash color; CRGB(255, 255, 255)
-            break;
-
-          // white blade
-          case COLOR_MODE_WHEEL_CYCLE_WHITE:
-          case COLOR_MODE_WHEEL_HOLD_WHITE:
-            blade.color = RGB_BLADE_WHITE;
-            blade.color_clash = RGB_BLADE_CLASH_YELLOW;
-            break;
-
-          // in all other instances, use the stock blade color
-          default:
-            blade.color = blade_color_table[blade.lightsaber->color_index][INDEX_COLOR_TABLE_COLOR];
-            blade.color_clash = blade_color_table[blade.lightsaber->color_index][INDEX_COLOR_TABLE_CLASH];
-            break;
-        }
+        blade_set_mode_colors();
+        #ifdef UNSTABLE_BLADE
+          blade.current_brightness_effect = blade.lightsaber->effect;
+        #endif
 
         // connect LED battery power
         #ifdef LED_PWR_SWITCH_PIN
@@ -173,13 +415,23 @@ void blade_manager() {
 
         // clear the LEDs immediately after they are powered on via LED_PWR_SWITCH_PIN
         LED_OBJ.clear();
+        POWER_CLEAR();
 
         // set the brightness for the blade
-        LED_OBJ.setBrightness(MAX_BRIGHTNESS);
+        blade_set_brightness(MAX_BRIGHTNESS);
         update_blade = true;
 
         // delay ignition based on whatever value is stored in the lightsaber's properties
         next_step = millis();
+        #ifdef IGNITION_CURVES
+          animate_rate = curve_rate(TIME_DECODE(blade.lightsaber->ignition_time));
+        #endif
+
+        // some lightsabers ignite with a clip rather than the stock animation; it's drawn in the
+        // blade's color, which is already calibrated for the strip
+        #ifdef ENABLE_CLIPS
+          playing_clip = clip_start(blade.lightsaber->ignition_clip, blade.color);
+        #endif
         break;
 
       // BLADE_ON is when the blade has just finished igniting; perhaps there's something we'll want to do only 
@@ -190,10 +442,6 @@ void blade_manager() {
 
       // blade is at idle
       case BLADE_IDLE:
-        #ifdef SERIAL_DEBUG_ENABLE
-          Serial.println(F("Blade State Change: BLADE_IDLE"));
-        #endif
-
         // some color modes may want to do something while the blade is idling
         switch (blade.color_mode) {
 
@@ -221,12 +469,50 @@ void blade_manager() {
 
       // a clash command has been sent; this happens when the blade hits something or the hilt stops suddenly
       case BLADE_CLASH:
-        #ifdef SERIAL_DEBUG_ENABLE
-          Serial.println(F("Blade State Change: BLADE_CLASH"));
+        // a clash on a fully lit blade flashes a random spot along it rather than the whole blade;
+        // the frame tick fades the flash out once we're back to idle
+        #ifdef CLASH_FLASH
+          if (BLADE_FULLY_LIT(previous_state)) {
+            shift = CLASH_FLASH_SHIFT;
+
+            #ifdef COMMAND_PATTERNS
+              switch (clash_pattern) {
+
+                // a lockup stays where it started, and keeps adding to the flash there
+                case PATTERN_LOCKUP:
+                  break;
+
+                // a drag is at the tip
+                case PATTERN_DRAG:
+                  clash_center = TARGET_MAX - 1;
+                  shift = CLASH_FLASH_SHIFT - 1;
+                  break;
+
+                // a blaster bolt is a small, sharp flash
+                case PATTERN_BLASTER:
+                  clash_center = BLADE_RANDOM_SPOT();
+                  shift = CLASH_FLASH_SHIFT - 2;
+                  break;
+
+                default:
+                  clash_center = BLADE_RANDOM_SPOT();
+                  break;
+              }
+            #else
+              clash_center = BLADE_RANDOM_SPOT();
+            #endif
+
+            clash_flash(clash_center, shift, 255, blade.color, blade.color_clash);
+            clash_frame(blade.color, blade.color_clash);
+            update_blade = true;
+            next_step = millis() + CLASH_FLASH_HOLD;
+            break;
+          }
         #endif
 
         // immediately set the blade to the clash color
         LED_FILL(blade.color_clash);
+        POWER_FILL(blade.color_clash);
         update_blade = true;
 
         // wait 40 milliseconds and then change the blade color back to normal
@@ -235,29 +521,26 @@ void blade_manager() {
 
       // the blade is turning off
       case BLADE_EXTINGUISHING:
-        #ifdef SERIAL_DEBUG_ENABLE
-          Serial.println(F("Blade State Change: BLADE_EXTINGUISHING"));
-        #endif
-
         last_extinguish = millis();
 
         // different lightsabers have different delays before the extinguish begins, so this statement sets that delay
         next_step = millis() + TIME_DECODE(blade.lightsaber->extinguish_time_delay);
+        #ifdef IGNITION_CURVES
+          animate_rate = curve_rate(TIME_DECODE(blade.lightsaber->extinguish_time));
+        #endif
         break;
 
       // every second or so the hilt sends this command to the blade. this is done to keep blade the correct color in the event
       // it should wiggle in its socket and momentarily lose connection and reset or a corrupted data command sets the blade
       // to a color other than what it should be
       case BLADE_REFRESH:
-        #ifdef SERIAL_DEBUG_ENABLE
-          Serial.println(F("Blade State Change: BLADE_REFRESH"));
-        #endif
-
         // set the blade color; this is needed for color-changing legacy hilts like Cal and Ahsoka
         if (blade.color_mode == COLOR_MODE_STOCK) {
-            blade.color = blade_color_table[blade.lightsaber->color_index][INDEX_COLOR_TABLE_COLOR];
-            blade.color_clash = blade_color_table[blade.lightsaber->color_index][INDEX_COLOR_TABLE_CLASH];
+            blade_set_mode_colors();
         }
+        #ifdef UNSTABLE_BLADE
+          blade.current_brightness_effect = blade.lightsaber->effect;
+        #endif
 
         // connect LED battery power
         #ifdef LED_PWR_SWITCH_PIN
@@ -266,9 +549,10 @@ void blade_manager() {
 
         // set the blade color
         LED_FILL(blade.color);
+        POWER_FILL(blade.color);
 
         // set brightness to max
-        LED_OBJ.setBrightness(MAX_BRIGHTNESS);
+        blade_set_brightness(MAX_BRIGHTNESS);
         update_blade = true;
 
         // change state to on
@@ -277,22 +561,14 @@ void blade_manager() {
 
       // low brightness flicker command; set the blade to some brightness level between 0 and 50% based on the value supplied
       case BLADE_FLICKER_LOW:
-        #ifdef SERIAL_DEBUG_ENABLE
-          Serial.println(F("Blade State Change: BLADE_FLICKER_LOW"));
-        #endif
-
-        LED_OBJ.setBrightness((uint8_t)(((float)(blade.cmd & 0x0F)/0x0F) * (MAX_BRIGHTNESS >> 1)));
+        blade_set_brightness((uint8_t)(((float)(blade.cmd & 0x0F)/0x0F) * (MAX_BRIGHTNESS >> 1)));
         update_blade = true;
         next_step = millis() + 40;
         break;
 
       // high brightness flicker command; set the blade to some brightness level between 50 and 100% based on the value supplied
       case BLADE_FLICKER_HIGH:
-        #ifdef SERIAL_DEBUG_ENABLE
-          Serial.println(F("Blade State Change: BLADE_FLICKER_HIGH"));
-        #endif
-
-        LED_OBJ.setBrightness((uint8_t)((1 + (float)(blade.cmd & 0x0F)/0x0F) * (MAX_BRIGHTNESS >> 1)));
+        blade_set_brightness((uint8_t)((1 + (float)(blade.cmd & 0x0F)/0x0F) * (MAX_BRIGHTNESS >> 1)));
         update_blade = true;
         next_step = millis() + 40;
         break;
@@ -300,6 +576,11 @@ void blade_manager() {
       default:
         break;
     }
+
+    // keep a copy of the blade's state that will survive a reset
+    #ifdef BLADE_SNAPSHOT
+      snapshot_save();
+    #endif
   }
 
   //
@@ -343,6 +624,29 @@ void blade_manager() {
       // animate the blade igniting by turning on 1 LED at a time
       case BLADE_IGNITING:
 
+        // play the ignition clip; frame n is shown n frame times after ignition began. normally
+        // that's one frame per pass, but if we've fallen behind, every late frame is decoded
+        // (they only hold what changed) and just the last one is shown
+        #ifdef ENABLE_CLIPS
+          if (playing_clip) {
+            while ((next_step + animate_step * clip_frame_time()) <= millis()) {
+
+              // the clip is over; leave the blade in its own color whatever the clip ended on
+              if (!clip_frame()) {
+                playing_clip = false;
+                LED_FILL(blade.color);
+                POWER_FILL(blade.color);
+                next_step = 0;
+                blade.state = BLADE_ON;
+                break;
+              }
+              animate_step++;
+              update_blade = true;
+            }
+            break;
+          }
+        #endif
+
         // calculate how much time has elapsed since ignition began and calculate how many LEDs should
         // be ignited at this point.
         if ((next_step + TIME_DECODE(blade.lightsaber->ignition_time)) <= millis()) {
@@ -350,7 +654,13 @@ void blade_manager() {
         } else {
 
           // calculate how many LEDs should be ON at this point in the ignition sequence
-          target = ((millis() - next_step) * TARGET_MAX) / TIME_DECODE(blade.lightsaber->ignition_time);
+          BENCH_MARK(BENCH_TARGET_BEGIN);
+          #ifdef IGNITION_CURVES
+            target = curve_leds(blade.lightsaber->ignition_curve, millis() - next_step, animate_rate, TARGET_MAX);
+          #else
+            target = ((millis() - next_step) * TARGET_MAX) / TIME_DECODE(blade.lightsaber->ignition_time);
+          #endif
+          BENCH_MARK(BENCH_TARGET_END);
 
           // do not allow target to go above TARGET_MAX
           if (target > TARGET_MAX) {
@@ -361,36 +671,12 @@ void blade_manager() {
         if (animate_step < target) {
           update_blade = true;
 
-          // if the LED_FILL_N macro exists (Adafruit NeoPixel) use that to help speed things up
-          // by filling multiple pixels in one step rather than incrementing through each pixel
-          // individually using LED_SET_PIXEL
-          #ifdef LED_FILL_N
-
-            // the fill command, if given a count value of 0, will fill the entire blade
-            // so make sure we have at least 1 LED to fill before using that fill command
-            if ((target - animate_step) > 0) {
-              LED_FILL_N(blade.color, animate_step, target - animate_step);
-
-              // if using MIRROR_MODE, start ignting from the end of the stip towards the center
-              #ifdef MIRROR_MODE
-                LED_FILL_N(blade.color, NUM_LEDS - target, target - animate_step);
-              #endif
-
-              // update animate_step
-              animate_step = target;
-            }
-          #else
-
-            // increment through each pixel in this block and set its color
-            while (animate_step < target) {
-              LED_SET_PIXEL(animate_step, blade.color);
-
-              #ifdef MIRROR_MODE
-                LED_SET_PIXEL((NUM_LEDS - 1) - animate_step, blade.color);
-              #endif
-              animate_step++;
-            }
-          #endif
+          // light the LEDs between where the last pass got to and target; this is one fill per
+          // half of the strip with libraries that can fill a span, a pixel at a time with those
+          // that can't (see blade_geometry.h)
+          POWER_SPAN(RGB_BLADE_OFF, blade.color, (target - animate_step) * Blade::copies);
+          Blade::fill(blade.color, animate_step, target);
+          animate_step = target;
         }
 
         // have we reached the end of the strip of LEDs?
@@ -403,22 +689,40 @@ void blade_manager() {
       // second part of the clash animation; set the blade back to its normal color
       case BLADE_CLASH:
 
+        #if defined(COLOR_CROSSFADE_TIME) || defined(CLASH_FLASH)
+          from = blade.color;
+        #endif
+
         // clash during color cycle momentarily select white
         if (blade.color_mode == COLOR_MODE_WHEEL_CYCLE) {
 
           blade.color_mode = COLOR_MODE_WHEEL_CYCLE_WHITE;
-          blade.color = RGB_BLADE_WHITE;
-          blade.color_clash = RGB_BLADE_CLASH_YELLOW;
+          blade_set_mode_colors();
 
         // if we're already in white for the wheel cycle, exit
         } else if (blade.color_mode == COLOR_MODE_WHEEL_CYCLE_WHITE) {
 
-          blade.color = color_by_wheel(wheel_index);
-          blade.color_clash = RGB_BLADE_CLASH_WHITE;
           blade.color_mode = COLOR_MODE_WHEEL_CYCLE;          
+          blade_set_mode_colors();
         }
+
+        // fade into white, or back out of it
+        #ifdef COLOR_CROSSFADE_TIME
+          if (blade.color != from) {
+            blade_crossfade(from);
+          }
+        #endif
         next_step = 0;
+
+        // the rest of the blade still holds its color around a flash; only a color change means a refill
+        #ifdef CLASH_FLASH
+          if (clash_active() && blade.color == from) {
+            blade.state = BLADE_IDLE;
+            break;
+          }
+        #endif
         LED_FILL(blade.color);
+        POWER_FILL(blade.color);
         blade.state = BLADE_IDLE;
         break;
 
@@ -427,56 +731,40 @@ void blade_manager() {
 
         // how many LEDs should be extinguished at this point in time?
         if ((next_step + TIME_DECODE(blade.lightsaber->extinguish_time)) <= millis()) {
-          target = TARGET_MAX;
+          target = EXTINGUISH_END;
         } else {
-          target = ((millis() - next_step) * TARGET_MAX) / TIME_DECODE(blade.lightsaber->extinguish_time);
-          if (target > TARGET_MAX) {
-              target = TARGET_MAX;
+          BENCH_MARK(BENCH_TARGET_BEGIN);
+          #ifdef IGNITION_CURVES
+            target = curve_leds(blade.lightsaber->extinguish_curve, millis() - next_step, animate_rate, EXTINGUISH_END);
+          #else
+            target = ((millis() - next_step) * EXTINGUISH_END) / TIME_DECODE(blade.lightsaber->extinguish_time);
+          #endif
+          BENCH_MARK(BENCH_TARGET_END);
+          if (target > EXTINGUISH_END) {
+              target = EXTINGUISH_END;
           }
         }
 
         // are there LEDs to turn off at this time?
         if (animate_step < target) {
 
-          // target = how many LEDs in total should be off
-          // aniamte_step = how many LEDs have already been turned off
+          // target = how many LEDs in total should be off (or, with a tail, have started to fade)
+          // animate_step = how many LEDs that was on the last pass
           //
-          // target - animate_step = how many LEDs we need to turn off this time
-
           // since target - animate > 0 we can assume the blade will need updating as we're turning off LEDs
           update_blade = true;
 
-          // LED_FILL_N is only in Adafruit library; shame, it's a useful function.
-          #ifdef LED_FILL_N
-            if ((target - animate_step) > 0) {
-
-              // MIRROR_MODE means the strip of pixels is folded back on itself to make up the blade.
-              #ifdef MIRROR_MODE
-                // in mirror mode, find the middle, subtract how many LEDs to turn off, then double how many we turn off to clear the middle of the LED strip
-                LED_FILL_N(RGB_BLADE_OFF, TARGET_MAX - target, target * 2);
-              #else
-                // otherwise, count back from the tip how many LEDs we need to turn off
-                // we can say only turn off target - animate_step here because everything closer to the tip should already be off
-                // maybe this saves a few cycles, but we don't have such savings in mirror mode
-                // would it be more readable to not use this little trick?
-                LED_FILL_N(RGB_BLADE_OFF, NUM_LEDS - target, target - animate_step);
-              #endif
-              animate_step = target;
-            }
-
-          // without LED_FILL_N we'll just turn them off one pixel at a time
+          // LEDs the tail has moved past go dark, then the tail is redrawn where it is now
+          #ifdef EXTINGUISH_TAIL_LEN
+            blade_extinguish_span(EXTINGUISH_DARK(animate_step), EXTINGUISH_DARK(target));
+            blade_extinguish_tail(target);
           #else
-            while (animate_step < target) {
-              LED_SET_PIXEL(TARGET_MAX - (animate_step + 1), RGB_BLADE_OFF);    // it took me far far too long to realize i needed +1 here
-              #ifdef MIRROR_MODE
-                LED_SET_PIXEL(TARGET_MAX + animate_step, RGB_BLADE_OFF);
-              #endif
-              animate_step++;
-            }
+            blade_extinguish_span(animate_step, target);
           #endif
+          animate_step = target;
         }
 
-        if (animate_step >= TARGET_MAX) {
+        if (animate_step >= EXTINGUISH_END) {
           next_step = 0;
           blade.state = BLADE_OFF;
         }
@@ -485,7 +773,7 @@ void blade_manager() {
       // second part of the flicker, reduce brightness by 20%
       case BLADE_FLICKER_LOW:
       case BLADE_FLICKER_HIGH:
-        LED_OBJ.setBrightness((uint8_t)((float)LED_OBJ.getBrightness() * .8));
+        blade_set_brightness((uint8_t)((float)blade.brightness * .8));
         update_blade = true;
         next_step = 0;
         blade.state = BLADE_IDLE;
@@ -512,22 +800,29 @@ void blade_manager() {
           // we've held white long enough...
           case COLOR_MODE_WHEEL_CYCLE_WHITE:
             blade.color_mode = COLOR_MODE_WHEEL_CYCLE;
-            blade.color_clash = RGB_BLADE_CLASH_WHITE;
 
           // if in the color wheel cycle mode
           case COLOR_MODE_WHEEL_CYCLE:
 
             // increment the wheel
-            wheel_index += COLOR_WHEEL_CYCLE_STEP;
+            blade.wheel_index += COLOR_WHEEL_CYCLE_STEP;
+
+            DEBUG_EVENT(TELEMETRY_WHEEL, blade.wheel_index);
 
-            #ifdef SERIAL_DEBUG_ENABLE
-              Serial.print(F("Next Color: "));
-              Serial.println(wheel_index);
+            #ifdef BLADE_SNAPSHOT
+              snapshot_save();
             #endif
 
             // set the new color by wheel
-            blade.color = color_by_wheel(wheel_index);
+            #ifdef COLOR_CROSSFADE_TIME
+              from = blade.color;
+              blade_set_mode_colors();
+              blade_crossfade(from);
+            #else
+              blade_set_mode_colors();
+            #endif
             LED_FILL(blade.color);
+            POWER_FILL(blade.color);
             update_blade = true;
             next_step = millis() + COLOR_WHEEL_PAUSE_TIME;
             break;
@@ -543,6 +838,62 @@ void blade_manager() {
 
   }
 
+  //
+  // ** BLADE MANAGER STAGE THREE : FRAME TICK **
+  //
+  // Some features need the blade redrawn continuously rather than only when something changes.
+  // While the blade is in a state that uses them, a frame is drawn at least every FRAME_TIME ms,
+  // and also on any pass where stages one or two changed the blade. Timed frames wait while a
+  // command may be coming in from the hilt; a SHOW_LEDS() every 8ms would otherwise land on the
+  // preamble or the bits often enough to lose commands. See cmd_incoming().
+  //
+  #if defined(TEMPORAL_DITHER) || defined(COLOR_CROSSFADE_TIME) || defined(UNSTABLE_BLADE) || defined(CLASH_FLASH)
+    if (BLADE_FULLY_LIT(blade.state) && (update_blade || ((int32_t)(millis() - next_frame) >= 0 && !cmd_incoming()))) {
+      next_frame = millis() + FRAME_TIME;
+
+      // next step of a color fade
+      #ifdef COLOR_CROSSFADE_TIME
+        if (blade_crossfade_step()) {
+          POWER_FILL(blade.color);
+          #ifndef TEMPORAL_DITHER
+            LED_FILL(blade.color);
+            update_blade = true;
+          #endif
+        }
+      #endif
+
+      // an unstable blade has its own frame to draw; it varies the brightness enough that
+      // dithering would be lost in it
+      #ifdef UNSTABLE_BLADE
+        if (BLADE_UNSTABLE()) {
+          BENCH_MARK(BENCH_NOISE_BEGIN);
+          noise_frame(blade.color);
+          BENCH_MARK(BENCH_NOISE_END);
+          unsettled = true;
+          update_blade = true;
+        }
+      #endif
+
+      // a flash is drawn at the LED library's brightness, so dithering sits out until it's over
+      #ifdef TEMPORAL_DITHER
+        if (!BLADE_UNSTABLE() && !BLADE_FLASHING()) {
+          blade_dither_frame();
+          update_blade = true;
+        } else if (dithering) {
+          blade_dither_stop();
+          update_blade = true;
+        }
+      #endif
+
+      // the flash goes over whatever else was drawn this frame
+      #ifdef CLASH_FLASH
+        if (clash_frame(blade.color, blade.color_clash)) {
+          update_blade = true;
+        }
+      #endif
+    }
+  #endif
+
   // update the LED strip with any changes
   if (update_blade) {
 
@@ -561,30 +912,113 @@ void blade_manager() {
       }
     #endif
 
+    // the contents of the strip may have changed since the brightness was last set; let the power
+    // governor decide if this frame can be shown at the requested brightness
+    #ifdef POWER_BUDGET_MA
+      #ifdef TEMPORAL_DITHER
+        if (!dithering)
+      #endif
+      LED_OBJ.setBrightness(POWER_BRIGHTNESS(BATTERY_BRIGHTNESS(blade.brightness)));
+    #endif
+
+    BENCH_MARK(BENCH_SHOW_BEGIN);
     SHOW_LEDS();
+    BENCH_MARK(BENCH_SHOW_END);
+
+    #ifdef WAKE_STATS
+      wake_stats_frame();
+    #endif
+
+  // the LEDs were left alone this pass; if the blade is sitting idle or off, this is a
+  // good time to check on the battery
+  #ifdef BATTERY_SENSE_PIN
+    } else if (blade.state == BLADE_IDLE || blade.state == BLADE_OFF) {
+      battery_sample();
+  #endif
   }
+
+  BENCH_MARK(BENCH_END);
+}
+
+// set the color and clash color of the blade based on the current color mode
+void blade_set_mode_colors() {
+  switch (blade.color_mode) {
+
+    // wheel color is based on wheel_index
+    case COLOR_MODE_WHEEL_CYCLE:
+    case COLOR_MODE_WHEEL_HOLD:
+      blade.color = color_by_wheel(blade.wheel_index);
+      blade.color_clash = RGB_BLADE_CLASH_WHITE;   // TODO: intelligently pick a clash color; CRGB(255, 255, 255)
+      break;
+
+    // white blade
+    case COLOR_MODE_WHEEL_CYCLE_WHITE:
+    case COLOR_MODE_WHEEL_HOLD_WHITE:
+      blade.color = RGB_BLADE_WHITE;
+      blade.color_clash = RGB_BLADE_CLASH_YELLOW;
+      break;
+
+    // in all other instances, use the stock blade color, or the profile's if there is one
+    default:
+      #ifdef USER_PROFILES
+        if (profile_colors(blade.profile, &blade.color, &blade.color_clash)) {
+          break;
+        }
+      #endif
+      blade.color = blade_color_table[blade.lightsaber->color_index][INDEX_COLOR_TABLE_COLOR];
+      blade.color_clash = blade_color_table[blade.lightsaber->color_index][INDEX_COLOR_TABLE_CLASH];
+      break;
+  }
+
+  // correct the colors for the LED strip; the pixels only ever get these two colors (scaled by
+  // brightness) so this is the only place calibration needs to be applied
+  blade.color = COLOR_CALIBRATE(blade.color);
+  blade.color_clash = COLOR_CALIBRATE(blade.color_clash);
+}
+
+// set the brightness the blade should be shown at
+void blade_set_brightness(uint8_t brightness) {
+  blade.brightness = brightness;
+  LED_OBJ.setBrightness(POWER_BRIGHTNESS(BATTERY_BRIGHTNESS(brightness)));
+}
+
+// pick lightsaber n; its index in the savi or legacy table, plus LIGHTSABER_LEGACY for a legacy one.
+// the number is kept alongside the settings so nothing has to work out which table they came from
+void blade_set_lightsaber(uint8_t n) {
+  const stock_lightsaber_t *table = (n & LIGHTSABER_LEGACY) ? legacy_lightsaber : savi_lightsaber;
+
+  blade.number = n;
+  blade.lightsaber = &table[n & 0x0F];
+  #ifdef USER_PROFILES
+    blade.profile = profile_slot(n);
+    if (blade.profile != PROFILE_NONE) {
+      blade.lightsaber = profile_settings(blade.profile);
+    }
+  #endif
 }
 
 
 // blade_process_command() will interpret the received command and set blade properties appropriately
 void blade_process_command() {
 
-  // DEBUG: display decoded command to serial monitor
-  #ifdef SERIAL_DEBUG_ENABLE
-    Serial.print(F("CMD: 0x"));
-    Serial.println(blade.cmd, HEX);
+  // DEBUG: log decoded command
+  DEBUG_EVENT(TELEMETRY_CMD, blade.cmd);
+
+  // look for lockups, drags, and blaster deflects in the commands coming in
+  #ifdef COMMAND_PATTERNS
+    clash_pattern = pattern_command(blade.cmd);
   #endif
 
   // identify command, set blade state and colors (if needed)
   switch (blade.cmd & 0xF0) {
 
     case 0x20:  // savi's ignite
-      blade.lightsaber = &savi_lightsaber[(blade.cmd & 0x0F) % LIGHTSABER_TABLE_LEN];
+      blade_set_lightsaber(blade.cmd & 0x0F);
       blade.state = BLADE_IGNITING;
       break;
 
     case 0x30:  // legacy ignite
-      blade.lightsaber = &legacy_lightsaber[(blade.cmd & 0x0F) % LIGHTSABER_TABLE_LEN];
+      blade_set_lightsaber(LIGHTSABER_LEGACY | (blade.cmd & 0x0F));
       blade.state = BLADE_IGNITING;
       break;
 
@@ -592,13 +1026,11 @@ void blade_process_command() {
 
       // only perform a blade refresh if the blade is in an idle state or if it's off (to force it on after a missed ignite)
       if (blade.state == BLADE_IDLE || blade.state == BLADE_OFF) {
-        blade.lightsaber = &savi_lightsaber[(blade.cmd & 0x0F) % LIGHTSABER_TABLE_LEN];
+        blade_set_lightsaber(blade.cmd & 0x0F);
         blade.state = BLADE_REFRESH;
       } else {
-        #ifdef SERIAL_DEBUG_ENABLE
-          Serial.print(F("Refresh blocked! Not in IDLE state; state is 0x"));
-          Serial.println(blade.state, HEX);
-        #endif
+        CMD_STAT_INC(cmd_stats.refresh_blocked);
+        DEBUG_EVENT(TELEMETRY_REFRESH_BLOCKED, blade.state);
       }
       break;
 
@@ -606,13 +1038,11 @@ void blade_process_command() {
 
       // only perform a blade refresh if the blade is in an idle state
       if (blade.state == BLADE_IDLE || blade.state == BLADE_OFF) {
-        blade.lightsaber = &legacy_lightsaber[(blade.cmd & 0x0F) % LIGHTSABER_TABLE_LEN];
+        blade_set_lightsaber(LIGHTSABER_LEGACY | (blade.cmd & 0x0F));
         blade.state = BLADE_REFRESH;
       } else {
-        #ifdef SERIAL_DEBUG_ENABLE
-          Serial.print(F("Refresh blocked! Not in IDLE state; state is 0x"));
-          Serial.println(blade.state, HEX);
-        #endif
+        CMD_STAT_INC(cmd_stats.refresh_blocked);
+        DEBUG_EVENT(TELEMETRY_REFRESH_BLOCKED, blade.state);
       }
       break;
 
@@ -649,6 +1079,29 @@ void blade_process_command() {
 void blade_setup() {
   // start the blade in an OFF state
   blade.state = BLADE_OFF;
+  blade.brightness = MAX_BRIGHTNESS;
+
+  // read any user profiles before a lightsaber is looked up
+  #ifdef USER_PROFILES
+    profile_load();
+  #endif
+
+  // until the hilt tells us otherwise, assume a white savi's blade; this keeps an extinguish
+  // or clash that arrives before any ignite or refresh from using a null lightsaber
+  blade_set_lightsaber(0);
+
+  // bring back the color mode, and locked in color, the blade had when it was last turned off
+  #ifdef REMEMBER_COLOR
+    journal_restore();
+  #endif
+
+  // if we're coming back from a reset (blade wiggled in its socket, brownout) pick up where we
+  // left off; a lit blade goes straight back on through a refresh without waiting on the hilt
+  #ifdef BLADE_SNAPSHOT
+    if (snapshot_restore()) {
+      blade_set_mode_colors();
+    }
+  #endif
 
   // set initial blade effects to stock
   blade.current_color_effect = 0;
@@ -32,13 +32,24 @@ typedef struct {
   blade_state_t state;
   uint8_t cmd;
   const stock_lightsaber_t *lightsaber;
+  uint8_t number;                       // which lightsaber that is; see LIGHTSABER_LEGACY
+  #ifdef USER_PROFILES
+    uint8_t profile;                    // slot of the profile it came from (see profile.h), or PROFILE_NONE
+  #endif
   LED_RGB_TYPE color;
   LED_RGB_TYPE color_clash;
+  uint8_t brightness;                   // brightness requested by the current state; the power governor may show the blade dimmer than this
   uint8_t current_color_effect;
   uint8_t current_brightness_effect;
   blade_color_mode_t color_mode;        // DELETE ME LATER
+  uint8_t wheel_index;                  // position on the color wheel for the color wheel modes
 } blade_t;
 
+extern blade_t blade;
+
 void blade_setup();
 void blade_manager();
 void blade_process_command();
+void blade_set_brightness(uint8_t brightness);
+void blade_set_lightsaber(uint8_t n);
+void blade_set_mode_colors();
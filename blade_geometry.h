@@ -0,0 +1,124 @@
+/* blade_geometry.h
+ * Blade geometry and LED backend, chosen at compile time.
+ *
+ * how a span of the blade maps onto the strip depends on MIRROR_MODE (is the strip folded back on
+ * itself?) and how it's best written depends on the LED library (can it fill a span in one call?).
+ * rather than test both with #ifdef everywhere a span is drawn, blade.cpp and clash.cpp draw
+ * through BladeGeometry, which is put together from:
+ *
+ *   a backend    SpanBackend for libraries that can fill a span (Adafruit NeoPixel, tinyNeoPixel,
+ *                the host build), ArrayBackend for a plain array of pixels (FastLED)
+ *   mirrored     true if the strip is folded in half, with pixel i and NumLeds - 1 - i side by side
+ *   NumLeds      pixels in the strip
+ *
+ * everything is static and inline, so the compiler sees straight through it to the same writes
+ * the #ifdef blocks made; nothing is decided while the blade is running. positions are counted
+ * from the hilt, 0 to length - 1, and in a mirrored blade each is drawn on both halves of the strip.
+ *
+ * Blade, at the bottom, is the geometry this sketch is built for. since the backend and geometry
+ * are template parameters, a host program can also put several side by side (see
+ * extras/host/geometry.cpp).
+ */
+#pragma once
+
+#include "hardware.h"
+
+// left to itself, the compiler may keep a span fill out of line to save a few bytes, which costs
+// a call on every pass; these are all small enough to always inline
+#define GEOMETRY_INLINE     inline __attribute__((always_inline))
+
+// for a strip object with setPixelColor(n, c) and fill(c, first, count)
+template <class Strip, Strip &strip>
+struct SpanBackend {
+  static const bool spans = true;
+
+  static GEOMETRY_INLINE void set(uint16_t n, LED_RGB_TYPE c) {
+    strip.setPixelColor(n, c);
+  }
+
+  // fill() treats a count of 0 as 'to the end of the strip'; BladeGeometry never asks for 0
+  static GEOMETRY_INLINE void fill(LED_RGB_TYPE c, uint16_t first, uint16_t count) {
+    strip.fill(c, first, count);
+  }
+};
+
+// for a plain array of pixels
+template <class Pixel, Pixel *pixels>
+struct ArrayBackend {
+  static const bool spans = false;
+
+  static GEOMETRY_INLINE void set(uint16_t n, LED_RGB_TYPE c) {
+    pixels[n] = c;
+  }
+
+  // BladeGeometry doesn't use this; it sets both halves of a mirrored blade in one loop instead
+  static GEOMETRY_INLINE void fill(LED_RGB_TYPE c, uint16_t first, uint16_t count) {
+    while (count--) {
+      pixels[first++] = c;
+    }
+  }
+};
+
+template <class Backend, bool mirrored, uint16_t NumLeds>
+struct BladeGeometry {
+  static const uint16_t length = mirrored ? (NumLeds + 1) / 2 : NumLeds;    // TARGET_MAX
+  static const uint8_t copies = mirrored ? 2 : 1;                          // pixels drawn for each position
+
+  // set position i
+  static GEOMETRY_INLINE void set(uint16_t i, LED_RGB_TYPE c) {
+    Backend::set(i, c);
+    if (mirrored) {
+      Backend::set((NumLeds - 1) - i, c);
+    }
+  }
+
+  // set positions 'from' up to 'to'; one fill for each half of the strip if the backend can fill
+  // a span, otherwise a pixel at a time, both halves in the same loop. 'from' must be less than
+  // 'to'; the callers have always just checked that, so it isn't checked again here
+  static GEOMETRY_INLINE void fill(LED_RGB_TYPE c, uint16_t from, uint16_t to) {
+    if (!Backend::spans) {
+      while (from < to) {
+        set(from++, c);
+      }
+    } else {
+      Backend::fill(c, from, to - from);
+      if (mirrored) {
+        Backend::fill(c, NumLeds - to, to - from);
+      }
+    }
+  }
+
+  // set positions 'from' up to 'to' counting in from the tip, so tip(from) is the first one set.
+  // the same pixels as fill() from tip(to - 1) up to tip(from) + 1, but without spans it's cheaper
+  // to walk the tip count than to work out the far end first
+  static GEOMETRY_INLINE void fill_tip(LED_RGB_TYPE c, uint16_t from, uint16_t to) {
+    if (!Backend::spans) {
+      while (from < to) {
+        set(tip(from++), c);
+      }
+    } else {
+      fill(c, length - to, length - from);
+    }
+  }
+
+  // position i, counting in from the tip
+  static GEOMETRY_INLINE uint16_t tip(uint16_t i) {
+    return (length - 1) - i;
+  }
+};
+
+#ifdef HOST_BUILD
+  typedef SpanBackend<HostLEDs, LED_OBJ> LedBackend;
+#elif defined(LEDLIB_FASTLED)
+  typedef ArrayBackend<LED_RGB_TYPE, leds> LedBackend;
+#elif defined(MEGATINYCORE)
+  typedef SpanBackend<tinyNeoPixel, LED_OBJ> LedBackend;
+#else
+  typedef SpanBackend<Adafruit_NeoPixel, LED_OBJ> LedBackend;
+#endif
+
+#ifdef MIRROR_MODE
+  typedef BladeGeometry<LedBackend, true, NUM_LEDS> Blade;
+#else
+  typedef BladeGeometry<LedBackend, false, NUM_LEDS> Blade;
+#endif
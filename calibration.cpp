@@ -0,0 +1,63 @@
+/* calibration.cpp
+ *
+ * each table entry is  white * (i / 255) ^ (COLOR_GAMMA / 10), rounded.
+ *
+ * C++11 has no constexpr pow(), and a loop can't be used to fill a table at compile time, so
+ * pow() is built from a natural log and exp() that are constexpr (each one a single return
+ * statement with recursion in place of loops), and the 256 entries of each table are written
+ * out by LUT_256() (see lut.h). all of it is evaluated by the compiler; none of this code ends
+ * up on the MCU except the tables and color_calibrate().
+ */
+#include "calibration.h"
+#include "config.h"
+#include "lut.h"
+
+#ifdef COLOR_GAMMA
+
+#define CAL_LN2     0.69314718055994530942
+
+// ln(x) for x in 0.5 .. 1 from the series  2 * (y + y^3/3 + y^5/5 ...)  where y = (x - 1) / (x + 1)
+constexpr double cal_ln_series(double y2, double p, int k) {
+  return (k > 16) ? 0 : p / (2 * k + 1) + cal_ln_series(y2, p * y2, k + 1);
+}
+
+// ln(x) for x > 0; halve the range until x is in 0.5 .. 1
+constexpr double cal_ln(double x) {
+  return (x < 0.5) ? cal_ln(x * 2) - CAL_LN2 : 2 * cal_ln_series(((x - 1) / (x + 1)) * ((x - 1) / (x + 1)), (x - 1) / (x + 1), 0);
+}
+
+// e^z for z in -0.5 .. 0 from the taylor series
+constexpr double cal_exp_series(double z, double term, int k) {
+  return (k > 12) ? 0 : term + cal_exp_series(z, term * z / (k + 1), k + 1);
+}
+
+constexpr double cal_sq(double v) {
+  return v * v;
+}
+
+// e^z for z <= 0; e^z = (e^(z/2))^2 until z is in -0.5 .. 0
+constexpr double cal_exp(double z) {
+  return (z < -0.5) ? cal_sq(cal_exp(z / 2)) : cal_exp_series(z, 1.0, 0);
+}
+
+// one table entry
+constexpr uint8_t cal_entry(int i, int white) {
+  return (i == 0) ? 0 : (uint8_t)(white * cal_exp((COLOR_GAMMA / 10.0) * cal_ln(i / 255.0)) + 0.5);
+}
+
+static const uint8_t calibration_lut[3][256] PROGMEM = {
+  { LUT_256(cal_entry, COLOR_WHITE_R) },
+  { LUT_256(cal_entry, COLOR_WHITE_G) },
+  { LUT_256(cal_entry, COLOR_WHITE_B) }
+};
+
+// correct a color for the LED strip
+LED_RGB_TYPE color_calibrate(LED_RGB_TYPE color) {
+  return LED_RGB(
+    pgm_read_byte(&calibration_lut[0][LED_RGB_R(color)]),
+    pgm_read_byte(&calibration_lut[1][LED_RGB_G(color)]),
+    pgm_read_byte(&calibration_lut[2][LED_RGB_B(color)])
+  );
+}
+
+#endif
@@ -0,0 +1,25 @@
+/* calibration.h
+ * Gamma and white balance correction of the blade colors.
+ *
+ * the colors in blade_color_table.h are PWM duty cycles measured from stock blade controllers.
+ * different LED strips don't all turn those into the same color; some need a gamma curve to
+ * look right and most have a white point that is a little off. with COLOR_GAMMA defined every
+ * color the blade is set to goes through a per-channel lookup table built from COLOR_GAMMA and
+ * COLOR_WHITE_R/G/B.
+ *
+ * the tables are worked out by the compiler and stored in program memory. they are applied
+ * when the blade's colors are chosen, not to the pixels, so there is no extra work per frame.
+ *
+ * if COLOR_GAMMA is not defined then all of this compiles away to nothing.
+ */
+#pragma once
+
+#include "hardware.h"
+
+#ifdef COLOR_GAMMA
+  LED_RGB_TYPE color_calibrate(LED_RGB_TYPE color);
+
+  #define COLOR_CALIBRATE(c)    color_calibrate(c)    // color c, corrected for the LED strip
+#else
+  #define COLOR_CALIBRATE(c)    (c)
+#endif
@@ -0,0 +1,118 @@
+/* clash.cpp
+ */
+#include "clash.h"
+#include "power.h"
+#include "blade_geometry.h"
+
+#ifdef CLASH_FLASH
+
+static uint16_t flash_start = 0;      // first pixel of the span
+static uint16_t flash_end = 0;        // one past the last pixel of the span; the span is empty when there's no flash
+static uint16_t flash_strength = 0;   // 8.8 fixed point
+static uint8_t flash_shift;           // the strength ramps up over 2^n pixels from each end of the span
+static uint32_t flash_next_decay;
+
+// blend two channel values; w 0 is all of a, 255 is almost all of b
+static inline uint8_t clash_blend(uint8_t a, uint8_t b, uint8_t w) {
+  return a + (((int16_t)b - a) * w >> 8);
+}
+
+// start a flash centered on the given pixel, reaching 2^shift pixels either side of it, or add to
+// the one already showing. color is the blade color the flash fades back to; flash is the clash color.
+void clash_flash(uint16_t center, uint8_t shift, uint8_t strength, LED_RGB_TYPE color, LED_RGB_TYPE flash) {
+  uint16_t half = 1 << shift;
+  uint16_t start = (center > half) ? (center - half) : 0;
+  uint16_t end = center + half + 1;
+  uint32_t total;
+  #ifdef POWER_BUDGET_MA
+    uint16_t before = flash_end - flash_start;
+  #endif
+
+  if (end > TARGET_MAX) {
+    end = TARGET_MAX;
+  }
+
+  if (flash_end == flash_start) {
+    flash_start = start;
+    flash_end = end;
+    flash_shift = shift;
+  } else {
+    flash_start = (start < flash_start) ? start : flash_start;
+    flash_end = (end > flash_end) ? end : flash_end;
+    flash_shift = (shift > flash_shift) ? shift : flash_shift;
+  }
+
+  // the power governor counts every pixel in the span as the full clash color until the flash
+  // is over; an overestimate, but only by the fading part of a short flash
+  POWER_SPAN(color, flash, ((flash_end - flash_start) - before) * Blade::copies);
+
+  total = flash_strength + ((uint16_t)strength << 8);
+  flash_strength = (total > 0xFFFF) ? 0xFFFF : total;
+  flash_next_decay = millis() + CLASH_FLASH_HOLD;
+}
+
+// draw the flash as it is now; returns false if there is no flash to draw
+bool clash_frame(LED_RGB_TYPE color, LED_RGB_TYPE flash) {
+  uint32_t up, down, s;
+  uint16_t ramp, i;
+  LED_RGB_TYPE c;
+
+  if (flash_end == flash_start) {
+    return false;
+  }
+
+  // fade by however many frame times have passed, even if some weren't drawn
+  while ((int32_t)(millis() - flash_next_decay) >= 0) {
+    flash_strength = ((uint32_t)flash_strength * CLASH_DECAY) >> 8;
+    flash_next_decay += FRAME_TIME;
+  }
+
+  // nothing left to see
+  if (flash_strength < 0x100) {
+    clash_end(color);
+    return true;
+  }
+
+  // the strength ramps up from each end of the span; up is the ramp from the start and down
+  // the ramp from the end, and each pixel gets whichever is lowest of the two and the strength
+  ramp = flash_strength >> flash_shift;
+  up = 0;
+  down = (uint32_t)ramp * (flash_end - flash_start);
+
+  for (i = flash_start; i < flash_end; i++) {
+    up += ramp;
+    s = (up < down) ? up : down;
+    s = (s < flash_strength) ? s : flash_strength;
+    down -= ramp;
+
+    c = LED_RGB(
+      clash_blend(LED_RGB_R(color), LED_RGB_R(flash), s >> 8),
+      clash_blend(LED_RGB_G(color), LED_RGB_G(flash), s >> 8),
+      clash_blend(LED_RGB_B(color), LED_RGB_B(flash), s >> 8)
+    );
+    Blade::set(i, c);
+  }
+  return true;
+}
+
+// stop the flash where it is and put the blade color back in its span
+void clash_end(LED_RGB_TYPE color) {
+  uint16_t i;
+
+  // once per flash, so a pixel at a time; two fills cost more in code than they save in time
+  for (i = flash_start; i < flash_end; i++) {
+    Blade::set(i, color);
+  }
+  POWER_FILL(color);
+
+  flash_start = 0;
+  flash_end = 0;
+  flash_strength = 0;
+}
+
+// true while a flash is showing
+bool clash_active() {
+  return flash_end != flash_start;
+}
+
+#endif
@@ -0,0 +1,37 @@
+/* clash.h
+ * Localized clash flash.
+ *
+ * the stock clash fills the whole blade with the clash color, holds it for 40ms, then fills the
+ * whole blade with the blade color again. with CLASH_FLASH, a clash instead lights up the part of
+ * the blade around where it hit and lets it fade out over the next couple hundred ms.
+ *
+ * the flash covers a span of the blade. its strength ramps up over 2^shift pixels (CLASH_FLASH_HALF
+ * for a clash) in from each end of the span and is flat in between, so a single clash peaks at the
+ * point it hit. each pixel in the span is the blade color blended towards the clash color by the
+ * strength there.
+ * after being held for CLASH_FLASH_HOLD ms the strength is cut to CLASH_DECAY / 256 of itself
+ * every FRAME_TIME ms.
+ *
+ * a clash that lands while a flash is still fading adds to its strength and stretches its span to
+ * cover both, rather than starting it over.
+ *
+ * drawing a frame touches only the pixels in the span. the ramps are running sums, so the only
+ * multiplies are the three it takes to blend each pixel's color.
+ */
+#pragma once
+
+#include "hardware.h"
+
+#ifdef CLASH_FLASH
+  #define CLASH_FLASH_SHIFT   4                           // a clash ramps up over 2^n pixels
+  #define CLASH_FLASH_HALF    (1 << CLASH_FLASH_SHIFT)
+  #define CLASH_FLASH_HOLD    40                          // ms the flash is held at full strength before it starts to fade
+  #ifndef CLASH_DECAY
+    #define CLASH_DECAY       208                         // out of 256; about 200ms from full strength to nothing
+  #endif
+
+  void clash_flash(uint16_t center, uint8_t shift, uint8_t strength, LED_RGB_TYPE color, LED_RGB_TYPE flash);
+  bool clash_frame(LED_RGB_TYPE color, LED_RGB_TYPE flash);
+  void clash_end(LED_RGB_TYPE color);
+  bool clash_active();
+#endif
@@ -0,0 +1,102 @@
+/* clip.cpp
+ */
+#include "clip.h"
+#include "power.h"
+#include "blade_geometry.h"
+
+#ifdef ENABLE_CLIPS
+
+#define CLIP_HEADER_LEN     7
+
+static const uint8_t *clip_palette;   // palette of the clip being played
+static const uint8_t *clip_next;      // next op to be read
+static uint16_t clip_frames_left = 0;
+static uint16_t clip_time;
+static LED_RGB_TYPE clip_color;       // blade color the clip is drawn in
+
+// read a two byte value out of program memory
+static uint16_t clip_read_word(const uint8_t *p) {
+  return pgm_read_byte(p) | (pgm_read_byte(p + 1) << 8);
+}
+
+// one channel of the blade color at a palette entry's level, pushed toward white
+static uint8_t clip_shade(uint8_t c, uint8_t level, uint8_t white) {
+  c = ((uint16_t)c * (level + 1)) >> 8;
+  return c + (((uint16_t)(255 - c) * white) >> 8);
+}
+
+// get ready to play a clip in the given color; returns false if there is no such clip
+bool clip_start(uint8_t id, LED_RGB_TYPE color) {
+  const uint8_t *clip;
+
+  if (id == CLIP_NONE || id >= CLIP_COUNT) {
+    clip_frames_left = 0;
+    return false;
+  }
+
+  clip = (const uint8_t *)pgm_read_ptr(&blade_clips[id]);
+  clip_time = clip_read_word(clip + 1);
+  clip_frames_left = clip_read_word(clip + 3);
+  clip_palette = clip + CLIP_HEADER_LEN;
+  clip_next = clip_palette + pgm_read_byte(clip) * 2;
+  clip_color = color;
+  return clip_frames_left > 0;
+}
+
+// how long, in ms, each frame of the current clip is shown for
+uint16_t clip_frame_time() {
+  return clip_time;
+}
+
+// decode the next frame of the clip into the LEDs; returns false, without touching the LEDs,
+// once the clip has run out of frames
+bool clip_frame() {
+  LED_RGB_TYPE color;
+  const uint8_t *shade;
+  uint8_t level, white;
+  uint16_t i = 0;
+  uint8_t op, n;
+
+  if (clip_frames_left == 0) {
+    return false;
+  }
+  clip_frames_left--;
+
+  while ((op = pgm_read_byte(clip_next++)) != CLIP_END_FRAME) {
+
+    // pixels that haven't changed
+    if (op < CLIP_RUN) {
+      i += op + 1;
+      continue;
+    }
+
+    // a run of pixels of one color
+    n = (op & 0x7F) + 1;
+    shade = clip_palette + pgm_read_byte(clip_next++) * 2;
+    level = pgm_read_byte(shade);
+    white = pgm_read_byte(shade + 1);
+    color = LED_RGB(
+      clip_shade(LED_RGB_R(clip_color), level, white),
+      clip_shade(LED_RGB_G(clip_color), level, white),
+      clip_shade(LED_RGB_B(clip_color), level, white)
+    );
+
+    // don't run off the end of the blade
+    if (i >= TARGET_MAX) {
+      continue;
+    }
+    if (n > TARGET_MAX - i) {
+      n = TARGET_MAX - i;
+    }
+
+    while (n--) {
+      POWER_SPAN(LED_GET_PIXEL(i), color, Blade::copies);
+      Blade::set(i, color);
+      i++;
+    }
+  }
+
+  return true;
+}
+
+#endif
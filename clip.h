@@ -0,0 +1,47 @@
+/* clip.h
+ * Playback of precompiled animation clips.
+ *
+ * some animations are too much work to compute on the fly on something like an ATtiny806. a clip
+ * is an animation rendered ahead of time by extras/clips/clip_encode.py and stored in program
+ * memory; playing it back costs flash rather than CPU. the encoder writes clip_data.h, which
+ * names each clip (CLIP_KYLO_IGNITE, ...), and clip_data.cpp, which holds the clips themselves.
+ *
+ * a clip is a header followed by a stream of frames:
+ *
+ *   palette count, frame time (ms, 2 bytes), frame count (2 bytes), LED count (2 bytes),
+ *   palette (2 bytes, level and white, per color)
+ *
+ * palette colors are shades of the blade color rather than fixed colors, so a clip follows a
+ * wheel mode or a profile color. level is how much of the blade color to show and white how far
+ * to push it toward white, both out of 255; see clip_shade().
+ *
+ * each frame is only what changed since the frame before it, as a list of ops:
+ *
+ *   0x00 - 0x7F    skip the next op + 1 pixels; they keep their color from the last frame
+ *   0x80 - 0xFE    set the next (op & 0x7F) + 1 pixels to the palette color whose index follows
+ *   0xFF           end of the frame
+ *
+ * two byte values are stored low byte first. the first frame is drawn over a blade that is off.
+ *
+ * frames are decoded one at a time straight into the LED library's pixels; there is no frame
+ * buffer of our own. a clip rendered for more LEDs than the blade has is cut off at the tip.
+ */
+#pragma once
+
+#include "hardware.h"
+#include "clip_data.h"
+
+#ifdef ENABLE_CLIPS
+  #define CLIP_RUN          0x80
+  #define CLIP_END_FRAME    0xFF
+
+  extern const uint8_t * const blade_clips[CLIP_COUNT];
+
+  bool clip_start(uint8_t id, LED_RGB_TYPE color);
+  uint16_t clip_frame_time();
+  bool clip_frame();
+
+  #if CLIP_LEDS != TARGET_MAX
+    #warning "the clips were rendered for a different number of LEDs than the blade has; regenerate them with extras/clips/clip_encode.py"
+  #endif
+#endif
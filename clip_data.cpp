@@ -0,0 +1,47 @@
+/* clip_data.cpp
+ * generated by extras/clips/clip_encode.py -l 144; do not edit
+ */
+#include "clip.h"
+
+#ifdef ENABLE_CLIPS
+
+// kylo_ignite: 25 frames, 478 bytes (10800 bytes uncompressed)
+static const uint8_t clip_kylo_ignite[] PROGMEM = {
+  0x05, 0x0A, 0x00, 0x19, 0x00, 0x90, 0x00, 0xFF, 0x80, 0xFF, 0x00, 0xE0, 0x00, 0xC0, 0x10, 0xA0,
+  0x00, 0x81, 0x00, 0xFF, 0x86, 0x01, 0x80, 0x02, 0x82, 0x00, 0xFF, 0x01, 0x80, 0x03, 0x02, 0x80,
+  0x03, 0x00, 0x80, 0x01, 0x80, 0x03, 0x82, 0x01, 0x82, 0x00, 0xFF, 0x01, 0x85, 0x01, 0x80, 0x04,
+  0x80, 0x01, 0x80, 0x04, 0x01, 0x80, 0x03, 0x85, 0x01, 0x82, 0x00, 0xFF, 0x05, 0x80, 0x02, 0x00,
+  0x85, 0x01, 0x80, 0x04, 0x04, 0x80, 0x02, 0x81, 0x01, 0x82, 0x00, 0xFF, 0x05, 0x89, 0x01, 0x80,
+  0x04, 0x02, 0x88, 0x01, 0x80, 0x04, 0x81, 0x01, 0x82, 0x00, 0xFF, 0x04, 0x80, 0x04, 0x04, 0x80,
+  0x02, 0x03, 0x94, 0x01, 0x82, 0x00, 0xFF, 0x01, 0x80, 0x02, 0x01, 0x86, 0x01, 0x80, 0x04, 0x02,
+  0x80, 0x03, 0x01, 0x80, 0x02, 0x05, 0x80, 0x02, 0x07, 0x80, 0x02, 0x00, 0x82, 0x01, 0x82, 0x00,
+  0xFF, 0x01, 0x81, 0x01, 0x80, 0x04, 0x01, 0x80, 0x02, 0x03, 0x81, 0x01, 0x80, 0x03, 0x00, 0x86,
+  0x01, 0x80, 0x02, 0x01, 0x94, 0x01, 0x82, 0x00, 0xFF, 0x80, 0x04, 0x00, 0x80, 0x03, 0x00, 0x84,
+  0x01, 0x80, 0x03, 0x80, 0x04, 0x80, 0x03, 0x01, 0x80, 0x02, 0x07, 0x88, 0x01, 0x80, 0x03, 0x03,
+  0x80, 0x03, 0x08, 0x83, 0x01, 0x81, 0x03, 0x80, 0x04, 0x80, 0x01, 0x82, 0x00, 0xFF, 0x8B, 0x01,
+  0x80, 0x02, 0x00, 0x82, 0x01, 0x80, 0x02, 0x06, 0x80, 0x04, 0x05, 0x85, 0x01, 0x80, 0x03, 0x08,
+  0x80, 0x04, 0x01, 0x85, 0x01, 0x80, 0x03, 0x80, 0x01, 0x82, 0x00, 0xFF, 0x80, 0x04, 0x01, 0x80,
+  0x04, 0x07, 0x80, 0x01, 0x80, 0x04, 0x02, 0xB1, 0x01, 0x82, 0x00, 0xFF, 0x94, 0x01, 0x80, 0x02,
+  0x01, 0x80, 0x04, 0x13, 0x80, 0x04, 0x0B, 0x80, 0x03, 0x07, 0x86, 0x01, 0x82, 0x00, 0xFF, 0x0A,
+  0x80, 0x03, 0x06, 0x80, 0x04, 0x00, 0x81, 0x01, 0x80, 0x04, 0x90, 0x01, 0x80, 0x04, 0x02, 0x80,
+  0x03, 0x80, 0x04, 0x08, 0x80, 0x04, 0x00, 0x92, 0x01, 0x82, 0x00, 0xFF, 0x0A, 0x92, 0x01, 0x80,
+  0x04, 0x80, 0x02, 0x08, 0x8F, 0x01, 0x80, 0x02, 0x09, 0x80, 0x02, 0x06, 0x80, 0x04, 0x80, 0x02,
+  0x80, 0x03, 0x82, 0x01, 0x82, 0x00, 0xFF, 0x1D, 0x83, 0x01, 0x80, 0x02, 0x05, 0x80, 0x04, 0x03,
+  0x80, 0x04, 0x09, 0x91, 0x01, 0x80, 0x03, 0x8E, 0x01, 0x82, 0x00, 0xFF, 0x21, 0x90, 0x01, 0x80,
+  0x03, 0x10, 0x80, 0x04, 0x04, 0x81, 0x01, 0x81, 0x03, 0x0B, 0x82, 0x01, 0x82, 0x00, 0xFF, 0x1E,
+  0x80, 0x02, 0x12, 0x87, 0x01, 0x80, 0x03, 0x08, 0xA1, 0x01, 0x80, 0x04, 0x82, 0x00, 0xFF, 0x1E,
+  0x96, 0x01, 0x80, 0x02, 0x03, 0x99, 0x01, 0x80, 0x03, 0x10, 0x84, 0x01, 0x82, 0x00, 0xFF, 0x0D,
+  0x80, 0x03, 0x15, 0x80, 0x04, 0x03, 0x80, 0x03, 0x08, 0x80, 0x02, 0x00, 0xBB, 0x01, 0x82, 0x00,
+  0xFF, 0x0D, 0x82, 0x01, 0x80, 0x03, 0x10, 0x80, 0x02, 0x00, 0x90, 0x01, 0x80, 0x03, 0x1B, 0x80,
+  0x02, 0x1D, 0x83, 0x01, 0x82, 0x00, 0xFF, 0x10, 0x8C, 0x01, 0x80, 0x02, 0x03, 0x8E, 0x01, 0x80,
+  0x02, 0x02, 0xA8, 0x01, 0x80, 0x03, 0x0E, 0x80, 0x03, 0x05, 0x84, 0x01, 0x80, 0x02, 0x83, 0x01,
+  0x82, 0x00, 0xFF, 0x1D, 0xA1, 0x01, 0x80, 0x03, 0x02, 0x80, 0x02, 0x19, 0xA6, 0x01, 0x82, 0x00,
+  0xFF, 0x29, 0x80, 0x04, 0x14, 0xCB, 0x01, 0x82, 0x00, 0xFF, 0x29, 0xE5, 0x01, 0xFF
+};
+
+const uint8_t * const blade_clips[CLIP_COUNT] PROGMEM = {
+  NULL,
+  clip_kylo_ignite
+};
+
+#endif
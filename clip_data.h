@@ -0,0 +1,11 @@
+/* clip_data.h
+ * generated by extras/clips/clip_encode.py -l 144; do not edit
+ */
+#pragma once
+
+#include <stdint.h>
+
+#define CLIP_NONE               0
+#define CLIP_LEDS               144     // number of LEDs the clips were rendered for
+#define CLIP_KYLO_IGNITE        1
+#define CLIP_COUNT              2
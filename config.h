@@ -44,8 +44,24 @@
                                         // if you are NOT using the FastLED library then you can ignore this
 #define NUM_LEDS                144     // number of LEDs in the strip
 #define MAX_BRIGHTNESS          64      // default brightness; lower value = lower current draw
+//#define POWER_BUDGET_MA         500   // uncomment to enable the power governor; the most current, in mA, the LED strip should be allowed to draw
+                                        // brightness is only lowered for frames that are estimated to go over this budget, so with the governor
+                                        // enabled MAX_BRIGHTNESS can be raised well above what an all-white blade could safely run at
+#define LED_CHANNEL_MA          20      // current, in mA, a single color channel of one LED draws at full duty; used by the power governor
+#define LED_IDLE_MA             1       // current, in mA, one LED draws even when it is dark; used by the power governor
+//#define BATTERY_SENSE_PIN       A1    // uncomment to enable battery voltage sensing; analog pin the battery is connected to through a voltage divider
+                                        // the battery is only sampled while the blade is idle or off, and never while a command is being received
+#define BATTERY_DIVIDER_RATIO   2       // battery voltage divided by the voltage seen on BATTERY_SENSE_PIN
+#define BATTERY_ADC_REF_MV      3300    // ADC reference voltage, in mV
+#define BATTERY_NOMINAL_MV      3700    // battery voltage, in mV, at which MAX_BRIGHTNESS looks right; brightness is raised as the battery drops below this
+#define BATTERY_EMPTY_MV        3300    // battery voltage, in mV, considered empty; used for the runtime estimate
+#define BATTERY_SAMPLE_INTERVAL 5000    // how often, in ms, to sample the battery voltage
 #define HILT_DATA_PIN           2       // digital pin the hilt's data line is connected to
 #define LED_DATA_PIN            4       // digital pin the LED strip is attached to
+//#define COLOR_GAMMA             22    // uncomment to enable color calibration; gamma, times 10, applied to every blade color (10 = no change)
+#define COLOR_WHITE_R           255     // white balance; the most red, green, and blue a full on channel is allowed, used only with COLOR_GAMMA.
+#define COLOR_WHITE_G           255     // lower one or two of these if white looks tinted on your strip
+#define COLOR_WHITE_B           255
 #define LED_PWR_SWITCH_PIN      0       // this pin is held low until the blade turns on, at which point it will be pushed high
                                         // this can be used to control a switch to connect and disconnect a battery switch; see: https://www.pololu.com/product/2811
                                         // if not using a switch, comment out this define
@@ -59,18 +75,54 @@
                                         // sleep will also stop the COM port of your microcontroller from appearing on your computer
                                         // set this as a large value while doing development, then lower it to 60000 or less for a
                                         // 'production' environment.
-//#define SERIAL_DEBUG_ENABLE           // enable debug messages over serial
+//#define SERIAL_DEBUG_ENABLE           // enable debug events over serial; decode them with extras/telemetry/telemetry_decode.py
 #define USE_DONT_SHOW                   // uncomment to enable DONT_SHOW; this blocks calls to update the LED string while a command is being read in from the hilt.
                                         // without this you risk, especially on slower microcontrollers, missing commands from the hilt.
                                         // i don't think there's any reason to disable this and I may remove this define and make DONT_SHOW permanent in the future.
 #define VALID_BIT_CUTOFF_IN_US  3750    // any bit period on the data line longer than this value, in microseconds, is considered an invalid bit of data and causes a reset of the data capture
 #define VALID_BIT_SPLIT_IN_US   1875    // any bit period longer than this value, in microseconds, but less than VALID_BIT_CUTOFF is treated as a valid 0 bit
                                         // any bit period shorter than this value, in microseconds, is treated as a valid 1 bit
+//#define ADAPTIVE_BIT_SPLIT            // uncomment to have the split between 0 and 1 bits learned from the refresh commands the hilt sends;
+                                        // it starts at VALID_BIT_SPLIT_IN_US and is kept within 25% of it. helps with hilts whose bits are slower
+                                        // than the stock 1200/2400us, or jittery; extras/host/bitsplit.sh compares the two
+//#define TEMPORAL_DITHER               // uncomment to dither the blade color over successive frames while the blade is lit; smooths out dim colors
+                                        // and low flicker levels at the cost of redrawing the strip every FRAME_TIME ms
+//#define UNSTABLE_BLADE                // uncomment to give lightsabers marked EFFECT_UNSTABLE in stock_blade_config.cpp (Kylo Ren) a flickering, crackling blade
+//#define CLASH_FLASH                   // uncomment to have a clash flash the part of the blade it hit and fade out, rather than flash the whole blade
+//#define COMMAND_PATTERNS              // uncomment to turn quick double clashes, runs of clashes, and clashes while swinging into blaster, lockup, and drag flashes; needs CLASH_FLASH
+//#define EXTINGUISH_TAIL_LEN     8     // uncomment to have the extinguish leave a tail of this many LEDs fading out behind it rather than a hard edge
+//#define IGNITION_CURVES               // uncomment to ignite and extinguish along the curves given to each lightsaber in stock_blade_config.cpp (see curve.h) rather than at a constant rate
+//#define USER_PROFILES                 // uncomment to let profiles in EEPROM replace the stock settings of any lightsaber (see profile.h); AVR boards only
+//#define REMEMBER_COLOR                // uncomment to keep the color mode and locked in color in EEPROM so they survive the blade being unplugged (see journal.h); AVR boards only
+#define FRAME_TIME              8       // how long, in ms, between frames when the blade is being redrawn continuously (TEMPORAL_DITHER, COLOR_CROSSFADE_TIME, UNSTABLE_BLADE, CLASH_FLASH)
 #define COLOR_MODE_CHANGE_TIME  1500    // if a blade is turned off then on again within this amount of time, then change to the next color mode
 #define COLOR_WHEEL_PAUSE_TIME  2000    // how long to hold a color before moving to the next color
 #define COLOR_WHEEL_CYCLE_STEP  16      // how many steps to jump when calculating the next color in the color cycle; a power of 2 is recommended
+//#define COLOR_CROSSFADE_TIME    400   // uncomment to fade, over this many ms, from one color to the next in the color wheel cycle rather than cut
+//#define ENABLE_CLIPS                  // uncomment to play the precompiled animation clips some lightsabers have in place of the stock ignition (see clip.h)
+                                        // costs a few KB of program space per clip; regenerate them with extras/clips/clip_encode.py if NUM_LEDS changes
 //#define USE_ADAFRUIT_NEOPIXEL         // uncomment to use the Adafruit NeoPixel library instead of FastLED
 //#define ENABLE_DEMO                   // define this to enable a demo program which will run instead of reading commands from the hilt.
                                         // i use this to test the blade without having to connect it to a hilt, just need to provide power and ground to the blade
+//#define ENABLE_BENCHMARK              // define this to have the code mark points of interest for the simavr cycle benchmark in extras/simavr_bench
 #define LATCH_DELAY_US          50      // define the length of delay, in microseconds, your RGB LEDs need in order to latch; default is 50 but mine need 280
                                         // used only with tinyNeoPixel (for now)
+
+// the host build (see extras/host) can be built for other configurations without editing this file
+#ifdef HOST_BUILD
+  #ifdef HOST_NUM_LEDS
+    #undef NUM_LEDS
+    #define NUM_LEDS              HOST_NUM_LEDS
+  #endif
+  #ifdef HOST_NO_DONT_SHOW
+    #undef USE_DONT_SHOW
+  #endif
+  #ifdef HOST_SLEEP_AFTER
+    #undef SLEEP_AFTER
+    #define SLEEP_AFTER           HOST_SLEEP_AFTER
+  #endif
+  #ifdef HOST_BATTERY_SAMPLE_INTERVAL
+    #undef BATTERY_SAMPLE_INTERVAL
+    #define BATTERY_SAMPLE_INTERVAL HOST_BATTERY_SAMPLE_INTERVAL
+  #endif
+#endif
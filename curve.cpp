@@ -0,0 +1,46 @@
+/* curve.cpp
+ */
+#include "curve.h"
+
+#ifdef IGNITION_CURVES
+
+// progress through the animation is kept as a fraction with 24 bits after the point; that leaves
+// room for the elapsed time (always less than the duration) times the rate in 32 bits
+#define CURVE_RATE_SHIFT    24
+#define CURVE_FRAC_SHIFT    (16 - CURVE_POINTS_SHIFT)
+
+// one table per curve, CURVE_LINEAR excepted; t^2, 1 - (1 - t)^2 and 3t^2 - 2t^3
+static const uint16_t curve_table[CURVE_COUNT - 1][CURVE_POINTS] PROGMEM = {
+  {     0,   256,  1024,  2304,  4096,  6400,  9216, 12544, 16384, 20736, 25600, 30976, 36864, 43264, 50176, 57600, 65535 },
+  {     0,  7936, 15360, 22272, 28672, 34560, 39936, 44800, 49152, 52992, 56320, 59136, 61440, 63232, 64512, 65280, 65535 },
+  {     0,   736,  2816,  6048, 10240, 15200, 20736, 26656, 32768, 38880, 44800, 50336, 55296, 59488, 62720, 64800, 65535 }
+};
+
+// how far through an animation of 'duration' ms each ms takes it; the only division
+uint32_t curve_rate(uint16_t duration) {
+  return duration ? ((1UL << CURVE_RATE_SHIFT) / duration) : 0;
+}
+
+// how many of 'n' LEDs the animation has reached 'elapsed' ms in, for a rate from curve_rate();
+// the caller handles elapsed being at or past the duration
+uint16_t curve_leds(uint8_t curve, uint32_t elapsed, uint32_t rate, uint16_t n) {
+  uint32_t p = (elapsed * rate) >> (CURVE_RATE_SHIFT - 16);   // 0 - 65535
+  uint16_t a, b, frac;
+  const uint16_t *point;
+
+  if (p > 0xFFFF) {
+    return n;
+  }
+
+  if (curve != CURVE_LINEAR && curve < CURVE_COUNT) {
+    point = &curve_table[curve - 1][p >> CURVE_FRAC_SHIFT];
+    frac = p & ((1 << CURVE_FRAC_SHIFT) - 1);
+    a = pgm_read_word(point);
+    b = pgm_read_word(point + 1);
+    p = a + ((((uint32_t)(b - a)) * frac) >> CURVE_FRAC_SHIFT);
+  }
+
+  return (p * n) >> 16;
+}
+
+#endif
@@ -0,0 +1,34 @@
+/* curve.h
+ * Easing curves for the ignition and extinguish.
+ *
+ * the stock ignition and extinguish light (or darken) the blade at a constant rate. with
+ * IGNITION_CURVES, each lightsaber in stock_blade_config.cpp picks a curve for each, so the blade
+ * can start slow and finish fast, or the other way around, to better fit the hilt's sound effects.
+ * the animation still takes exactly as long as the stock timing says; only how the LEDs are spread
+ * over that time changes.
+ *
+ * each curve is a table of CURVE_POINTS values, evenly spaced in time, from 0 to 65535 (all the
+ * way), and is linearly interpolated between them. CURVE_LINEAR doesn't need a table.
+ *
+ * the stock animation divides by the animation's duration on every pass. with curves, that
+ * division is done once when the animation starts (curve_rate()) and every pass after that is a
+ * few multiplies and shifts (curve_leds()).
+ */
+#pragma once
+
+#include "hardware.h"
+
+// curves a stock lightsaber can be given in stock_blade_config.cpp
+#define CURVE_LINEAR        0       // the stock animation
+#define CURVE_EASE_IN       1       // starts slow, finishes fast
+#define CURVE_EASE_OUT      2       // starts fast, finishes slow
+#define CURVE_EASE_IN_OUT   3       // slow at both ends
+#define CURVE_COUNT         4
+
+#ifdef IGNITION_CURVES
+  #define CURVE_POINTS_SHIFT  4                           // 2^n segments per curve
+  #define CURVE_POINTS        ((1 << CURVE_POINTS_SHIFT) + 1)
+
+  uint32_t curve_rate(uint16_t duration);
+  uint16_t curve_leds(uint8_t curve, uint32_t elapsed, uint32_t rate, uint16_t n);
+#endif
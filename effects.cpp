@@ -1,6 +1,8 @@
 /* effects.cpp
  */
 #include "effects.h"
+#include "telemetry.h"
+#include "hsv.h"
 
 effect_interface_t *color_effects[REGISTRY_MAX];
 effect_interface_t *brightness_effects[REGISTRY_MAX];
@@ -27,9 +29,7 @@ bool register_effect(effect_interface_t *effect_interface, effect_class_t effect
   switch(effect_class) {
     case EFFECT_CLASS_COLOR:
       if (color_effects_len >= REGISTRY_MAX) {
-        #ifdef SERIAL_DEBUG_ENABLE
-          Serial.println(F("ERROR: register_effect() color effects registry full"));
-        #endif
+        DEBUG_EVENT(TELEMETRY_EFFECT_ERROR, effect_class);
         return false;
         color_effects[color_effects_len] = effect_interface;
         color_effects_len++;
@@ -37,18 +37,14 @@ bool register_effect(effect_interface_t *effect_interface, effect_class_t effect
       break;
     case EFFECT_CLASS_BRIGHTNESS:
       if (brightness_effects_len >= REGISTRY_MAX) {
-        #ifdef SERIAL_DEBUG_ENABLE
-          Serial.println(F("ERROR: register_effect() brightness effects registry full"));
-        #endif
+        DEBUG_EVENT(TELEMETRY_EFFECT_ERROR, effect_class);
         return false;
         brightness_effects[brightness_effects_len] = effect_interface;
         brightness_effects_len++;
       }
       break;
     default:
-      #ifdef SERIAL_DEBUG_ENABLE
-        Serial.println(F("ERROR: register_effect() invalid effect class"));
-      #endif
+      DEBUG_EVENT(TELEMETRY_EFFECT_ERROR, effect_class);
       return false;
       break;
   }
@@ -56,17 +52,8 @@ bool register_effect(effect_interface_t *effect_interface, effect_class_t effect
 }
 
 
-// generate an RGB color based on an 8-bit input value
+// generate an RGB color based on an 8-bit input value; a fully saturated hue (see hsv.h)
 LED_RGB_TYPE color_by_wheel(uint8_t wheel) {
-  wheel = 255 - wheel;
-  if (wheel < 85) {
-    return(LED_RGB(255 - wheel * 3, 0, wheel * 3));
-  } else if (wheel < 170) {
-    wheel -= 85;
-    return(LED_RGB(0, wheel * 3, 255 - wheel * 3));
-  } else {
-    wheel -= 170;
-    return(LED_RGB(wheel * 3, 255 - wheel * 3, 0));
-  }
+  return color_by_hsv(wheel, 255, 255);
 }
 
@@ -7,6 +7,10 @@
 
 #define REGISTRY_MAX          10
 
+// brightness effects a stock lightsaber can be given in stock_blade_config.cpp
+#define EFFECT_NONE           0
+#define EFFECT_UNSTABLE       1       // flickering, crackling blade (see noise.h); needs UNSTABLE_BLADE
+
 typedef struct {
   void (*init)();           // Called when effect becomes active
   uint16_t (*update)();     // Called after init() the first time, then after N milliseconds where N is a value returned by update()
@@ -0,0 +1,193 @@
+#!/usr/bin/env python3
+# clip_encode.py
+#
+# render blade animations offline and encode them as clips the blade controller plays back from
+# program memory (see clip.h in the sketch for the format). writes clip_data.h and clip_data.cpp,
+# which go in the sketch folder next to clip.h.
+#
+#   clip_encode.py [-l LEDS] [-o DIR] [-d FILE]
+#
+# options:
+#   -l LEDS   number of LEDs to render for; NUM_LEDS, or (NUM_LEDS + 1) / 2 with MIRROR_MODE (default 144)
+#   -o DIR    where to write clip_data.h and clip_data.cpp (default: the sketch folder)
+#   -d FILE   also write every rendered frame, as raw RGB bytes for a red blade, to FILE; handy for
+#             checking the decoder against the host build's trace output
+#
+# to add a clip, write a function that returns a list of frames (each a list of (level, white)
+# tuples, one per LED) and add it to CLIPS below. a clip is drawn in whatever color the blade is,
+# so a wheel mode or a profile color carries through it: level is how much of the blade color to
+# show, out of 255, and white how far to push that toward white, out of 255 (e.g. for a hot tip).
+# frames are played FRAME_TIME ms apart. the first frame is drawn over a blade that is off.
+
+import os
+import random
+import sys
+
+FRAME_TIME = 10                 # ms between frames
+
+SKIP_MAX = 128                  # 0x00 - 0x7F: skip 1 - 128 pixels
+RUN_MAX = 127                   # 0x80 - 0xFE: set 1 - 127 pixels to the palette color that follows
+END_FRAME = 0xFF
+
+
+def kylo_ignite(leds):
+    """Kylo Ren's unstable blade igniting: a blade that sputters out to full length over 240ms,
+    the stock ignition time for legacy index 1, with a hot tip and a crackling core that calms
+    down as it reaches the tip. the clip is the whole ignition; the blade is left in its own
+    color as soon as it's over."""
+    rng = random.Random(1)
+    ignition = 240
+    frames = []
+    crackle = [(224, 0), (192, 16), (160, 0)]
+    for t in range(0, ignition + 1, FRAME_TIME):
+        # the blade lurches forward rather than extending smoothly. each frame is shown for
+        # FRAME_TIME ms, so it's drawn where the stock ignition would be halfway through that
+        extent = max(0, min(leds, int(leds * (t + FRAME_TIME / 2) / ignition + rng.randint(-2, 2))))
+        frame = []
+        for i in range(leds):
+            if i >= extent:
+                frame.append((0, 0))
+            elif t < ignition and i >= extent - 3:
+                frame.append((255, 128))
+            elif t < ignition and rng.random() < 0.15 * (ignition - t) / ignition:
+                frame.append(rng.choice(crackle))
+            else:
+                frame.append((255, 0))
+        frames.append(frame)
+    return frames
+
+
+def shade(entry, color):
+    """the color the blade shows for a palette entry; the same sums as clip_frame()"""
+    level, white = entry
+    out = []
+    for c in color:
+        c = (c * (level + 1)) >> 8
+        out.append(c + (((255 - c) * white) >> 8))
+    return tuple(out)
+
+
+# clip name, function; the clip's id in the sketch is CLIP_<NAME> and its position in this list, + 1
+CLIPS = [
+    ("kylo_ignite", kylo_ignite),
+]
+
+
+def encode(frames):
+    palette = []
+    index = {}
+    data = bytearray()
+    last = [(0, 0)] * len(frames[0])
+
+    for frame in frames:
+        i = 0
+        end = len(data)
+        while i < len(frame):
+            # pixels that haven't changed since the last frame are skipped
+            n = 0
+            while i + n < len(frame) and frame[i + n] == last[i + n] and n < SKIP_MAX:
+                n += 1
+            if n:
+                data.append(n - 1)
+                i += n
+                continue
+
+            # a run of one color
+            color = frame[i]
+            if color not in index:
+                if len(palette) == 255:
+                    sys.exit("more than 255 colors in one clip")
+                index[color] = len(palette)
+                palette.append(color)
+            n = 1
+            while i + n < len(frame) and frame[i + n] == color and n < RUN_MAX:
+                n += 1
+            data.append(0x80 | (n - 1))
+            data.append(index[color])
+            end = len(data)
+            i += n
+
+        # skips after the last run are left out; the end of the frame does the same job
+        del data[end:]
+        data.append(END_FRAME)
+        last = frame
+
+    header = bytearray([len(palette), FRAME_TIME & 0xFF, FRAME_TIME >> 8,
+                        len(frames) & 0xFF, len(frames) >> 8,
+                        len(frames[0]) & 0xFF, len(frames[0]) >> 8])
+    for entry in palette:
+        header += bytes(entry)
+    return header + data
+
+
+def c_array(data):
+    lines = []
+    for i in range(0, len(data), 16):
+        lines.append("  " + ", ".join("0x%02X" % b for b in data[i:i + 16]))
+    return ",\n".join(lines)
+
+
+def main(argv):
+    leds = 144
+    out = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..")
+    dump = None
+    args = list(argv[1:])
+    while args:
+        opt = args.pop(0)
+        if opt == "-l":
+            leds = int(args.pop(0))
+        elif opt == "-o":
+            out = args.pop(0)
+        elif opt == "-d":
+            dump = open(args.pop(0), "wb")
+        else:
+            sys.exit("usage: clip_encode.py [-l leds] [-o dir] [-d file]")
+
+    header = ["/* clip_data.h",
+              " * generated by extras/clips/clip_encode.py -l %d; do not edit" % leds,
+              " */",
+              "#pragma once",
+              "",
+              "#include <stdint.h>",
+              "",
+              "#define CLIP_NONE               0",
+              "#define %-24s%-8d// number of LEDs the clips were rendered for" % ("CLIP_LEDS", leds)]
+    source = ["/* clip_data.cpp",
+              " * generated by extras/clips/clip_encode.py -l %d; do not edit" % leds,
+              " */",
+              "#include \"clip.h\"",
+              "",
+              "#ifdef ENABLE_CLIPS",
+              ""]
+    for n, (name, render) in enumerate(CLIPS):
+        frames = render(leds)
+        data = encode(frames)
+        raw = sum(len(f) * 3 for f in frames)
+        if dump:
+            for frame in frames:
+                for entry in frame:
+                    dump.write(bytes(shade(entry, (255, 0, 0))))
+        header.append("#define %-24s%d" % ("CLIP_" + name.upper(), n + 1))
+        source.append("// %s: %d frames, %d bytes (%d bytes uncompressed)" % (name, len(frames), len(data), raw))
+        source.append("static const uint8_t clip_%s[] PROGMEM = {" % name)
+        source.append(c_array(data))
+        source.append("};")
+        source.append("")
+        print("%s: %d frames, %d bytes, %d uncompressed" % (name, len(frames), len(data), raw))
+
+    header.append("#define %-24s%d" % ("CLIP_COUNT", len(CLIPS) + 1))
+    source.append("const uint8_t * const blade_clips[CLIP_COUNT] PROGMEM = {")
+    source.append("  NULL,")
+    source.append(",\n".join("  clip_%s" % name for name, _ in CLIPS))
+    source.append("};")
+    source.append("")
+    source.append("#endif")
+
+    with open(os.path.join(out, "clip_data.h"), "w") as f:
+        f.write("\n".join(header) + "\n")
+    with open(os.path.join(out, "clip_data.cpp"), "w") as f:
+        f.write("\n".join(source) + "\n")
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,34 @@
+/* EEPROM.h
+ * The Arduino EEPROM library for HOST_BUILD.
+ *
+ * a 1KB EEPROM, the size of an ATmega328P's (or HOST_EEPROM_LEN bytes), that starts out erased (every byte 0xFF). writes
+ * that change a byte take HOST_EEPROM_WRITE_US of virtual time, as they would on an AVR, and are
+ * counted so wear can be measured. host_eeprom_load() and host_eeprom_save() copy it to and from
+ * a file.
+ */
+#pragma once
+
+#include <stdint.h>
+
+#ifndef HOST_EEPROM_LEN
+  #define HOST_EEPROM_LEN     1024
+#endif
+#define E2END                 (HOST_EEPROM_LEN - 1)   // as avr/io.h has it
+#define HOST_EEPROM_WRITE_US  3400
+
+class HostEEPROM {
+  public:
+    HostEEPROM();
+    uint8_t read(int idx) { return data[idx]; }
+    void write(int idx, uint8_t val);
+    void update(int idx, uint8_t val) { write(idx, val); }
+    uint16_t length() { return HOST_EEPROM_LEN; }
+
+    uint8_t data[HOST_EEPROM_LEN];
+    uint32_t writes[HOST_EEPROM_LEN];   // writes that changed each byte
+};
+extern HostEEPROM EEPROM;
+
+bool host_eeprom_load(const char *path);
+bool host_eeprom_save(const char *path);
+uint32_t host_eeprom_writes(uint32_t *most);
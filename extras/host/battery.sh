@@ -0,0 +1,15 @@
+#!/bin/sh
+# build blade_battery with BATTERY_SENSE_PIN and run it
+#
+# usage: battery.sh
+#
+# exits with a non-zero status if the battery is sampled at the wrong time or compensated wrongly
+
+cd "$(dirname "$0")" || exit 1
+
+# sampling every 20ms rather than every few seconds puts samples all through the short states
+# (igniting, clash, a command coming in) the check is looking for them in
+
+build="build/battery"
+make -s BUILD="$build" EXTRA="-DBATTERY_SENSE_PIN=A1 -DHOST_BATTERY_SAMPLE_INTERVAL=20" "$build/blade_battery" >&2 || exit 1
+"$build/blade_battery" "$@"
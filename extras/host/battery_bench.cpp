@@ -0,0 +1,172 @@
+/* battery_bench.cpp
+ * Check battery voltage sensing against a scripted battery.
+ *
+ * the voltage on BATTERY_SENSE_PIN is scripted through host_analog_hook. two things are checked:
+ *
+ *   sampling      the sketch is run through an ignite, a stretch of refreshes, a clash and an
+ *                 extinguish, with commands sent as pulses on the data pin. every ADC reading
+ *                 has to be taken while the blade is idle or off and no command is coming in,
+ *                 and there have to be readings in both states.
+ *   compensation  for a range of battery voltages, battery_mv() has to settle on the voltage and
+ *                 battery_brightness() has to raise brightness by BATTERY_NOMINAL_MV / voltage,
+ *                 never going below it, capped at 255, and no higher below BATTERY_EMPTY_MV.
+ *
+ * battery.sh builds this with BATTERY_SENSE_PIN defined and a short BATTERY_SAMPLE_INTERVAL.
+ *
+ * usage: blade_battery
+ *
+ * prints a line per check and exits with a non-zero status if any of them fail.
+ */
+#include "host_arduino.h"
+#include "hardware.h"
+#include "hilt_cmd.h"
+#include "blade.h"
+#include "battery.h"
+
+#ifdef BATTERY_SENSE_PIN
+
+#define LOOP_US         20        // virtual time each pass of loop() takes
+
+// hilt protocol timings in microseconds; a short LOW period is a 1 bit, a long one a 0 bit
+#define PREAMBLE_US     16400
+#define BIT_ONE_US      1200
+#define BIT_ZERO_US     2400
+#define BIT_HIGH_US     1200
+
+void setup();
+void loop();
+
+static uint16_t battery_now_mv = BATTERY_NOMINAL_MV;
+static uint32_t reads_off = 0;
+static uint32_t reads_idle = 0;
+static uint32_t reads_bad = 0;
+static int failures = 0;
+
+// the ADC reading for the scripted battery voltage; every reading is checked against the blade's state
+static int battery_adc(uint8_t pin) {
+  if (pin != BATTERY_SENSE_PIN) {
+    return 0;
+  }
+  #ifdef USE_DONT_SHOW
+    if (dont_show) {
+      reads_bad++;
+    }
+  #endif
+  if (blade.state == BLADE_OFF) {
+    reads_off++;
+  } else if (blade.state == BLADE_IDLE) {
+    reads_idle++;
+  } else {
+    reads_bad++;
+  }
+  return ((uint32_t)battery_now_mv * 1023) / ((uint32_t)BATTERY_ADC_REF_MV * BATTERY_DIVIDER_RATIO);
+}
+
+// queue the pulses for one command
+static void send_pulses(uint64_t t, uint8_t cmd) {
+  host_pin_edge(t, LOW);
+  t += PREAMBLE_US;
+  host_pin_edge(t, HIGH);
+  t += PREAMBLE_US;
+  host_pin_edge(t, LOW);
+  t += PREAMBLE_US;
+  host_pin_edge(t, HIGH);
+  t += BIT_HIGH_US;
+
+  for (int i = 7; i >= 0; i--) {
+    host_pin_edge(t, LOW);
+    t += ((cmd >> i) & 1) ? BIT_ONE_US : BIT_ZERO_US;
+    host_pin_edge(t, HIGH);
+    t += BIT_HIGH_US;
+  }
+}
+
+static void run_for(uint32_t ms) {
+  uint64_t until = host_time_us() + (uint64_t)ms * 1000;
+
+  while (host_time_us() < until) {
+    loop();
+    host_advance(LOOP_US);
+  }
+}
+
+static void result(const char *check, const char *detail, bool ok) {
+  printf("%s\t%s\t%s\n", check, detail, ok ? "ok" : "FAIL");
+  if (!ok) {
+    failures++;
+  }
+}
+
+// run a savi's session with the battery slowly sagging; every ADC reading is checked as it's taken
+static void check_sampling() {
+  char detail[64];
+  uint32_t t;
+
+  setup();
+  run_for(2000);
+
+  send_pulses(host_time_us(), 0x21);
+  for (t = 0; t < 30; t++) {
+    if (t == 12) {
+      send_pulses(host_time_us() + 300000, 0xC1);
+    }
+    send_pulses(host_time_us() + 500000, 0xA1);
+    run_for(1000);
+    battery_now_mv -= 5;
+  }
+  send_pulses(host_time_us(), 0x41);
+  run_for(2000);
+
+  snprintf(detail, sizeof(detail), "off %u, idle %u, other %u", reads_off, reads_idle, reads_bad);
+  result("sampling", detail, reads_off > 0 && reads_idle > 0 && reads_bad == 0);
+}
+
+// settle the average on 'mv' and check the brightness compensation there
+static void check_compensation(uint16_t mv) {
+  char detail[64];
+  uint16_t avg, floor_mv, expect, got, i;
+  bool ok = true;
+
+  battery_now_mv = mv;
+  for (i = 0; i < 40; i++) {
+    host_advance(BATTERY_SAMPLE_INTERVAL * 1000UL);
+    battery_sample();
+  }
+  avg = battery_mv();
+
+  // the ADC is 10 bits; a step is a few mV once through the divider
+  if (avg + 8 < mv || avg > mv + 8) {
+    ok = false;
+  }
+
+  floor_mv = (avg > BATTERY_EMPTY_MV) ? avg : BATTERY_EMPTY_MV;
+  for (i = 0; i < 256 && ok; i += 17) {
+    expect = (avg >= BATTERY_NOMINAL_MV) ? i : (((uint32_t)i * BATTERY_NOMINAL_MV) / floor_mv);
+    expect = (expect > 255) ? 255 : expect;
+    got = battery_brightness(i);
+    ok = (got == expect) && (got >= i);
+  }
+
+  snprintf(detail, sizeof(detail), "%u mV, averaged %u mV, brightness 64 -> %u", mv, avg, battery_brightness(64));
+  result("compensation", detail, ok);
+}
+
+int main() {
+  static const uint16_t voltages[] = { 4200, 3700, 3600, 3500, 3400, 3300, 3100 };
+
+  host_analog_hook = battery_adc;
+  check_sampling();
+  for (uint8_t i = 0; i < sizeof(voltages) / sizeof(voltages[0]); i++) {
+    check_compensation(voltages[i]);
+  }
+  return failures ? 1 : 0;
+}
+
+#else
+
+int main() {
+  fprintf(stderr, "blade_battery needs a build with BATTERY_SENSE_PIN; see battery.sh\n");
+  return 1;
+}
+
+#endif
@@ -0,0 +1,42 @@
+#!/bin/sh
+# compare a fixed bit split against ADAPTIVE_BIT_SPLIT, switched on in config.h, for a hilt with
+# stock bit timings and an off-spec one, both with some jitter on every bit
+#
+# usage: bitsplit.sh [commands per run]
+#
+# prints the totals over every strip length, backend and traffic pattern blade_decoder models, and
+# exits with a non-zero status if ADAPTIVE_BIT_SPLIT decodes noticeably fewer commands correctly
+# than the fixed split for either hilt
+
+cd "$(dirname "$0")" || exit 1
+count="${1:-200}"
+status=0
+
+./config_sketch.sh build/bitsplit-sketch ADAPTIVE_BIT_SPLIT || exit 1
+
+printf "hilt\tadaptive\tsent\tok\tlost\tcorrupt\n"
+for hilt in stock:1200:2400 offspec:1600:2800; do
+  name="${hilt%%:*}"
+  timing="${hilt#*:}"
+  extra="-DBIT_ONE_US=${timing%:*} -DBIT_ZERO_US=${timing#*:} -DBIT_JITTER_US=300"
+  fixed_ok=
+
+  for adaptive in 0 1; do
+    build="build/bitsplit-$name-$adaptive"
+    sketch=../..
+    if [ "$adaptive" = 1 ]; then
+      sketch=build/bitsplit-sketch
+    fi
+    make -s SKETCH="$sketch" BUILD="$build" EXTRA="$extra" "$build/blade_decoder" >&2 || exit 1
+
+    # sent, ok, lost and corrupt summed over every row
+    set -- $("$build/blade_decoder" "$count" | awk 'NR > 1 { s += $5; o += $6; l += $7; c += $8 } END { print s, o, l, c }')
+    printf "%s\t%s\t%s\t%s\t%s\t%s\n" "$name" "$adaptive" "$1" "$2" "$3" "$4"
+    if [ -z "$fixed_ok" ]; then
+      fixed_ok=$2
+    elif [ "$2" -lt $((fixed_ok - $1 / 100)) ]; then
+      status=1
+    fi
+  done
+done
+exit $status
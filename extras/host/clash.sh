@@ -0,0 +1,15 @@
+#!/bin/sh
+# build blade_clash with CLASH_FLASH for several strip lengths and run each one
+#
+# usage: clash.sh [clashes]
+
+cd "$(dirname "$0")" || exit 1
+status=0
+
+printf "leds\tstock_us_per_clash\tflash_frames\tflash_us_per_frame\tflash_us_per_clash\tstock_pixels\tflash_pixels\n"
+for leds in 30 79 144 250; do
+  build="build/clash-$leds"
+  make -s BUILD="$build" EXTRA="-DCLASH_FLASH -DHOST_NUM_LEDS=$leds" "$build/blade_clash" >&2 || exit 1
+  "$build/blade_clash" "$@" || status=1
+done
+exit $status
@@ -0,0 +1,72 @@
+/* clash_bench.cpp
+ * Time the localized clash flash against the stock clash.
+ *
+ * the stock clash fills the whole strip twice: once with the clash color and, 40ms later, once
+ * with the blade color. the flash draws its span on every frame until it has faded out. this
+ * prints, for one strip length: the number of LEDs, the time for the stock clash's two fills,
+ * the number of frames a flash lasts, the time to draw one frame of it, the time for the whole
+ * flash, and the pixels written by each. the timings are for the host CPU and only useful relative
+ * to each other; run clash.sh to get a line per strip length.
+ *
+ * clash_flash() only exists in a build with CLASH_FLASH; clash.sh builds it that way.
+ *
+ * usage: blade_clash [clashes]
+ */
+#include <time.h>
+#include "host_arduino.h"
+#include "hardware.h"
+#include "clash.h"
+#include "blade_color_table.h"
+
+#ifdef CLASH_FLASH
+
+static double elapsed_us(struct timespec *start, struct timespec *end) {
+  return ((end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec)) / 1000;
+}
+
+int main(int argc, char *argv[]) {
+  long clashes = (argc > 1) ? atol(argv[1]) : 20000;
+  struct timespec start, end;
+  uint32_t color = RGB_BLADE_BLUE;
+  uint32_t flash = RGB_BLADE_CLASH_WHITE;
+  long frames = 0;
+  double stock_us, flash_us;
+  int span;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long n = 0; n < clashes; n++) {
+    LED_FILL(flash);
+    LED_FILL(color);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  stock_us = elapsed_us(&start, &end) / clashes;
+
+  // flashes at the middle of the blade, so the span is never cut short by either end
+  span = (2 * CLASH_FLASH_HALF + 1 < TARGET_MAX) ? (2 * CLASH_FLASH_HALF + 1) : TARGET_MAX;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long n = 0; n < clashes; n++) {
+    clash_flash(TARGET_MAX / 2, CLASH_FLASH_SHIFT, 255, color, flash);
+    clash_frame(color, flash);
+    host_advance(CLASH_FLASH_HOLD * 1000);
+    while (clash_frame(color, flash)) {
+      host_advance(FRAME_TIME * 1000);
+      frames++;
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  flash_us = elapsed_us(&start, &end) / clashes;
+  frames /= clashes;
+
+  printf("%d\t%.3f\t%ld\t%.3f\t%.3f\t%d\t%ld\n", NUM_LEDS, stock_us, frames + 1, flash_us / (frames + 1), flash_us,
+    2 * NUM_LEDS, (frames + 1) * span * ((NUM_LEDS == TARGET_MAX) ? 1 : 2));
+  return 0;
+}
+
+#else
+
+int main() {
+  fprintf(stderr, "blade_clash needs a build with CLASH_FLASH; see clash.sh\n");
+  return 1;
+}
+
+#endif
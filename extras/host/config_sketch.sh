@@ -0,0 +1,32 @@
+#!/bin/sh
+# copy the sketch into a directory and switch options on in its config.h, the way they're switched
+# on for a blade: by uncommenting their line. the copy can then be built with make SKETCH=<dir>, so
+# an option gets the same treatment from the host build as it does from the Arduino IDE (unlike
+# EXTRA="-D...", which defines it before any of the sketch's headers are read).
+#
+# usage: config_sketch.sh <dir> <option>...
+#
+#   NAME          uncomment "//#define NAME"
+#   NAME=VALUE    uncomment "//#define NAME" and give it VALUE
+#
+# exits with a non-zero status if an option has no commented out line in config.h
+
+dir="$1"
+shift
+sketch="$(dirname "$0")/../.."
+
+mkdir -p "$dir" || exit 1
+cp "$sketch"/*.cpp "$sketch"/*.h "$sketch"/*.ino "$dir" || exit 1
+
+for option in "$@"; do
+  name="${option%%=*}"
+  if ! grep -q "^//#define $name\b" "$dir/config.h"; then
+    echo "config_sketch.sh: no '//#define $name' in config.h" >&2
+    exit 1
+  fi
+  if [ "$name" = "$option" ]; then
+    sed -i "s|^//#define $name\b|#define $name|" "$dir/config.h"
+  else
+    sed -i "s|^//#define $name\b\( *\)[^ ]*|#define $name\1${option#*=}|" "$dir/config.h"
+  fi
+done
@@ -0,0 +1,252 @@
+/* decoder.cpp
+ * Model how often commands from the hilt are lost or corrupted while the LEDs are being shown.
+ *
+ * show() holds interrupts off for about 30us per LED. while it does, edges on the hilt data pin
+ * can't be timed by the pin interrupt; only one pending interrupt is kept, so pulses that begin
+ * and end during a show() are lost and the one that does get through is mis-measured. hilt_cmd.cpp
+ * works through the numbers by hand; this runs the real read_cmd() against simulated traffic
+ * with those interrupt blackouts and counts what comes out the other end.
+ *
+ * for every strip length, LED backend, and traffic pattern a stream of commands is sent and each
+ * command decoded is matched against the command that was being sent at the time:
+ *
+ *   ok        decoded command matches what was sent
+ *   corrupt   a command was decoded, but not the one that was sent
+ *   lost      nothing was decoded for a command that was sent
+ *
+ * LED backends modelled:
+ *
+ *   fastled      interrupts off during show(); millis()/micros() are corrected afterwards
+ *   adafruit     interrupts off during show(); millis()/micros() lose the time spent in show()
+ *   tcb_capture  the ATtiny event system and TCB0 time pulses in hardware (USE_AVR_EV_CAPT); the
+ *                capture register still only holds the most recent pulse when show() ends
+ *
+ * USE_DONT_SHOW is a compile time setting; decoder.sh builds this with and without it.
+ *
+ * usage: blade_decoder [commands per run]
+ */
+#include <vector>
+#include "host_arduino.h"
+#include "hardware.h"
+#include "hilt_cmd.h"
+#include "bench.h"
+
+#define LOOP_US         20        // virtual time each pass of loop() takes
+#define SHOW_US_PER_LED 30
+
+// hilt protocol timings in microseconds; a short LOW period is a 1 bit, a long one a 0 bit.
+// the bit periods can be overridden (e.g. EXTRA="-DBIT_ONE_US=1600") to model an off-spec hilt,
+// and given some jitter (EXTRA="-DBIT_JITTER_US=300") to model a noisy one; see bitsplit.sh
+#define PREAMBLE_US     16400
+#ifndef BIT_ONE_US
+  #define BIT_ONE_US    1200
+#endif
+#ifndef BIT_ZERO_US
+  #define BIT_ZERO_US   2400
+#endif
+#ifndef BIT_JITTER_US
+  #define BIT_JITTER_US 0       // each LOW period is off by up to this much either way
+#endif
+#define BIT_HIGH_US     1200
+
+void setup();
+void loop();
+
+typedef enum {
+  BACKEND_FASTLED,
+  BACKEND_ADAFRUIT,
+  BACKEND_TCB_CAPTURE
+} backend_t;
+
+static const char *backend_names[] = { "fastled", "adafruit", "tcb_capture" };
+
+typedef enum {
+  PATTERN_REFRESH,      // refresh about once a second, as a hilt does while idle
+  PATTERN_FLICKER,      // a back to back stream of flicker commands
+  PATTERN_CLASH,        // a back to back stream of clashes
+  PATTERN_CYCLE,        // ignite and extinguish over and over; commands arrive mid-animation
+  PATTERN_RANDOM        // any command, random gaps
+} pattern_t;
+
+static const char *pattern_names[] = { "refresh", "flicker", "clash", "cycle", "random" };
+
+typedef struct {
+  uint64_t start_us;
+  uint64_t end_us;      // end of the last bit
+  uint8_t cmd;
+  uint8_t decoded;
+  bool seen;
+} sent_t;
+
+static std::vector<sent_t> sent;
+static size_t matching = 0;
+static uint32_t corrupt = 0;
+
+// TCB0 capture model
+static uint64_t fall_us = 0;
+static uint32_t capture = 0;
+
+// every decoded command is matched against the most recent command whose bits have all been sent
+static void on_marker(uint8_t marker) {
+  if (marker != BENCH_CMD_DECODED) {
+    return;
+  }
+  while (matching + 1 < sent.size() && sent[matching + 1].end_us <= host_time_us()) {
+    matching++;
+  }
+  if (matching < sent.size() && !sent[matching].seen && sent[matching].end_us <= host_time_us()) {
+    sent[matching].seen = true;
+    sent[matching].decoded = hilt_cmd;
+  } else {
+    corrupt++;
+  }
+}
+
+// the capture hardware times every LOW pulse, even while interrupts are off
+static void tcb_edge(uint64_t at_us, uint8_t level) {
+  if (level == LOW) {
+    fall_us = at_us;
+  } else {
+    capture = (uint32_t)(at_us - fall_us);
+  }
+}
+
+// the capture interrupt; only the most recent capture is available to it
+static void tcb_isr() {
+  if (capture) {
+    cmd_pulse_period = capture;
+    capture = 0;
+  }
+}
+
+// queue the pulses for one command; returns when the last bit ends
+static uint64_t send_pulses(uint64_t t, uint8_t cmd) {
+  host_pin_edge(t, LOW);
+  t += PREAMBLE_US;
+  host_pin_edge(t, HIGH);
+  t += PREAMBLE_US;
+  host_pin_edge(t, LOW);
+  t += PREAMBLE_US;
+  host_pin_edge(t, HIGH);
+  t += BIT_HIGH_US;
+
+  for (int i = 7; i >= 0; i--) {
+    host_pin_edge(t, LOW);
+    t += (((cmd >> i) & 1) ? BIT_ONE_US : BIT_ZERO_US) + random(-BIT_JITTER_US, BIT_JITTER_US + 1);
+    host_pin_edge(t, HIGH);
+    t += (i > 0) ? BIT_HIGH_US : 0;
+  }
+  return t;
+}
+
+static void run_until(uint64_t until) {
+  while (host_time_us() < until) {
+    loop();
+    host_advance(LOOP_US);
+  }
+}
+
+// the next command, and the gap in ms before it, for a traffic pattern
+static uint8_t next_cmd(pattern_t pattern, uint32_t n, uint32_t *gap_ms) {
+  static const uint8_t any[] = { 0x21, 0xA1, 0xC1, 0x65, 0x7A, 0x41, 0x31, 0xB1, 0xD1, 0x51 };
+
+  switch (pattern) {
+    case PATTERN_REFRESH:
+      *gap_ms = 1000;
+      return 0xA1;
+    case PATTERN_FLICKER:
+      *gap_ms = 0;
+      return ((n & 1) ? 0x60 : 0x70) | (random(16));
+    case PATTERN_CLASH:
+      *gap_ms = 0;
+      return 0xC1;
+    case PATTERN_CYCLE:
+      *gap_ms = 150;
+      return (n & 1) ? 0x41 : 0x21;
+    case PATTERN_RANDOM:
+    default:
+      *gap_ms = random(200);
+      return any[random(sizeof(any))];
+  }
+}
+
+static void run(uint16_t strip, backend_t backend, pattern_t pattern, uint32_t count) {
+  uint64_t t;
+  uint32_t ok = 0, lost = 0, wrong = 0, i, gap;
+
+  LED_OBJ.show_us = strip * SHOW_US_PER_LED;
+  LED_OBJ.show_halts_clock = (backend == BACKEND_ADAFRUIT);
+  if (backend == BACKEND_TCB_CAPTURE) {
+    host_edge_hook = tcb_edge;
+    attachInterrupt(digitalPinToInterrupt(HILT_DATA_PIN), tcb_isr, CHANGE);
+  } else {
+    host_edge_hook = NULL;
+    cmd_capture_setup();
+  }
+
+  // start every run from a lit blade; these first commands are not counted
+  sent.clear();
+  matching = 0;
+  corrupt = 0;
+  t = send_pulses(host_time_us() + 1000, 0x80) + 200000;
+  t = send_pulses(t, 0x21) + 500000;
+  run_until(t);
+  sent.clear();
+  corrupt = 0;
+
+  // queue and play the traffic; the pulses are queued a command or two ahead of the clock
+  for (i = 0; i < count; i++) {
+    sent_t s;
+
+    s.cmd = next_cmd(pattern, i, &gap);
+    s.start_us = t + (uint64_t)gap * 1000;
+    s.end_us = send_pulses(s.start_us, s.cmd);
+    s.decoded = 0;
+    s.seen = false;
+    sent.push_back(s);
+    t = s.end_us + BIT_HIGH_US;
+
+    while (host_pending_edges() > 64) {
+      run_until(host_time_us() + 1000);
+    }
+  }
+  run_until(t + 500000);
+
+  for (i = 0; i < sent.size(); i++) {
+    if (!sent[i].seen) {
+      lost++;
+    } else if (sent[i].decoded == sent[i].cmd) {
+      ok++;
+    } else {
+      wrong++;
+    }
+  }
+  wrong += corrupt;
+
+  #ifdef USE_DONT_SHOW
+    printf("%u\t%s\t1\t", strip, backend_names[backend]);
+  #else
+    printf("%u\t%s\t0\t", strip, backend_names[backend]);
+  #endif
+  printf("%s\t%u\t%u\t%u\t%u\t%.4f\t%.4f\n", pattern_names[pattern], count, ok, lost, wrong,
+    (double)lost / count, (double)wrong / count);
+}
+
+int main(int argc, char *argv[]) {
+  static const uint16_t lengths[] = { 30, 60, 100, 144, 200, 250, 300 };
+  uint32_t count = (argc > 1) ? strtoul(argv[1], NULL, 0) : 200;
+
+  randomSeed(1);
+  host_marker = on_marker;
+  setup();
+
+  printf("leds\tbackend\tdont_show\tpattern\tsent\tok\tlost\tcorrupt\tloss_rate\tcorrupt_rate\n");
+  for (uint8_t l = 0; l < sizeof(lengths) / sizeof(lengths[0]); l++) {
+    for (uint8_t b = BACKEND_FASTLED; b <= BACKEND_TCB_CAPTURE; b++) {
+      for (uint8_t p = PATTERN_REFRESH; p <= PATTERN_RANDOM; p++) {
+        run(lengths[l], (backend_t)b, (pattern_t)p, count);
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,12 @@
+#!/bin/sh
+# build blade_decoder with and without USE_DONT_SHOW and run both
+#
+# usage: decoder.sh [commands per run]
+
+cd "$(dirname "$0")" || exit 1
+
+make -s BUILD=build/decoder-1 build/decoder-1/blade_decoder >&2 || exit 1
+make -s BUILD=build/decoder-0 EXTRA="-DHOST_NO_DONT_SHOW" build/decoder-0/blade_decoder >&2 || exit 1
+
+build/decoder-1/blade_decoder "$@"
+build/decoder-0/blade_decoder "$@" | tail -n +2
@@ -0,0 +1,147 @@
+/* geometry.cpp
+ * Check BladeGeometry for several strip lengths and both backends in one program.
+ *
+ * the sketch is built for one geometry, the one config.h picks, but blade_geometry.h can be put
+ * together any way at all. this builds every combination of backend (a HostLEDs strip through
+ * SpanBackend, a plain array through ArrayBackend), mirrored or not, and a few strip lengths, and
+ * for each one checks set(), fill(), fill_tip() and tip() against a pixel-at-a-time reference, over
+ * every span the blade has. it then times filling the whole blade one position at a time, the way
+ * an ignition does, and prints a line per config: backend, mirrored, NUM_LEDS, length, result, and
+ * the time for one ignition's worth of fills. the timings are for the host CPU and only useful
+ * relative to each other.
+ *
+ * usage: blade_geometry [ignitions]
+ *
+ * exits with a non-zero status if any config fails.
+ */
+#include <time.h>
+#include "host_arduino.h"
+#include "host_leds.h"
+#include "blade_geometry.h"
+
+#define MAX_LEDS    144
+#define COLOR       0x123456
+#define DARK        0
+
+// not static; gnu++11 only takes objects with external linkage as template arguments
+HostLEDs span_strip(MAX_LEDS);
+uint32_t array_pixels[MAX_LEDS];
+static uint32_t expect[MAX_LEDS];
+static int failures = 0;
+
+typedef SpanBackend<HostLEDs, span_strip> HostSpan;
+typedef ArrayBackend<uint32_t, array_pixels> HostArray;
+
+static uint32_t pixel(bool array, uint16_t n) {
+  return array ? array_pixels[n] : span_strip.getPixelColor(n);
+}
+
+static double elapsed_us(struct timespec *start, struct timespec *end) {
+  return ((end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec)) / 1000;
+}
+
+// what drawing position p on a blade of n pixels should write
+static void reference_set(bool mirrored, uint16_t n, uint16_t p, uint32_t c) {
+  expect[p] = c;
+  if (mirrored) {
+    expect[n - 1 - p] = c;
+  }
+}
+
+template <class Backend, uint16_t NumLeds>
+static void clear() {
+  uint16_t i;
+
+  for (i = 0; i < NumLeds; i++) {
+    Backend::set(i, DARK);
+    expect[i] = DARK;
+  }
+}
+
+template <uint16_t NumLeds>
+static bool matches(bool array) {
+  uint16_t i;
+
+  for (i = 0; i < NumLeds; i++) {
+    if (pixel(array, i) != expect[i]) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <class Backend, bool mirrored, uint16_t NumLeds>
+static void check(const char *name, long ignitions) {
+  typedef BladeGeometry<Backend, mirrored, NumLeds> G;
+  bool array = !Backend::spans;
+  struct timespec start, end;
+  bool ok = (G::length == (mirrored ? (NumLeds + 1) / 2 : NumLeds)) && (G::copies == (mirrored ? 2 : 1));
+  uint16_t from, to, p;
+
+  // one position at a time, from each end
+  for (p = 0; ok && p < G::length; p++) {
+    clear<Backend, NumLeds>();
+    G::set(p, COLOR);
+    reference_set(mirrored, NumLeds, p, COLOR);
+    ok = matches<NumLeds>(array);
+
+    clear<Backend, NumLeds>();
+    G::set(G::tip(p), COLOR);
+    reference_set(mirrored, NumLeds, G::length - 1 - p, COLOR);
+    ok = ok && matches<NumLeds>(array);
+  }
+
+  // every span
+  for (from = 0; ok && from < G::length; from++) {
+    for (to = from + 1; ok && to <= G::length; to++) {
+      clear<Backend, NumLeds>();
+      G::fill(COLOR, from, to);
+      for (p = from; p < to; p++) {
+        reference_set(mirrored, NumLeds, p, COLOR);
+      }
+      ok = matches<NumLeds>(array);
+
+      // the same span, counted in from the tip
+      clear<Backend, NumLeds>();
+      G::fill_tip(COLOR, from, to);
+      for (p = from; p < to; p++) {
+        reference_set(mirrored, NumLeds, G::length - 1 - p, COLOR);
+      }
+      ok = ok && matches<NumLeds>(array);
+    }
+  }
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long n = 0; n < ignitions; n++) {
+    for (p = 0; p < G::length; p++) {
+      G::fill((uint32_t)n, p, p + 1);
+    }
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  if (!ok) {
+    failures++;
+  }
+  printf("%s\t%d\t%d\t%d\t%s\t%.3f\n", name, mirrored, NumLeds, G::length, ok ? "ok" : "FAIL",
+         elapsed_us(&start, &end) / ignitions);
+}
+
+template <class Backend>
+static void check_lengths(const char *name, long ignitions) {
+  check<Backend, false, 1>(name, ignitions);
+  check<Backend, false, 60>(name, ignitions);
+  check<Backend, false, 144>(name, ignitions);
+  check<Backend, true, 1>(name, ignitions);
+  check<Backend, true, 59>(name, ignitions);
+  check<Backend, true, 60>(name, ignitions);
+  check<Backend, true, 144>(name, ignitions);
+}
+
+int main(int argc, char *argv[]) {
+  long ignitions = (argc > 1) ? atol(argv[1]) : 20000;
+
+  printf("backend\tmirrored\tNUM_LEDS\tlength\tresult\tus_per_ignition\n");
+  check_lengths<HostSpan>("span", ignitions);
+  check_lengths<HostArray>("array", ignitions);
+  return failures ? 1 : 0;
+}
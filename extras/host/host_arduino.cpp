@@ -0,0 +1,224 @@
+/* host_arduino.cpp
+ */
+#include "host_arduino.h"
+#include "EEPROM.h"
+
+HostSerial Serial;
+HostEEPROM EEPROM;
+HostMarker GPIOR0;
+void (*host_marker)(uint8_t marker) = NULL;
+void (*host_edge_hook)(uint64_t at_us, uint8_t level) = NULL;
+int (*host_analog_hook)(uint8_t pin) = NULL;
+
+HostMarker &HostMarker::operator=(uint8_t v) {
+  if (host_marker) {
+    host_marker(v);
+  }
+  return *this;
+}
+
+#define MAX_EDGES   4096
+
+static uint64_t now_us = 0;
+static uint64_t halted_us = 0;        // time millis() and micros() missed while their clock was halted
+static bool irq_enabled = true;
+static bool irq_pending = false;
+static void (*pin_isr)() = NULL;
+static uint8_t pin_level = HIGH;
+
+// queue of edges on the hilt data pin; a ring buffer ordered by time
+static struct {
+  uint64_t at_us;
+  uint8_t level;
+} edges[MAX_EDGES];
+static uint32_t edge_head = 0;
+static uint32_t edge_tail = 0;
+
+uint32_t millis() {
+  return (uint32_t)((now_us - halted_us) / 1000);
+}
+
+uint32_t micros() {
+  return (uint32_t)(now_us - halted_us);
+}
+
+void delay(unsigned long ms) {
+  host_advance(ms * 1000);
+}
+
+void delayMicroseconds(unsigned int us) {
+  host_advance(us);
+}
+
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+
+// only the hilt data pin is simulated
+int digitalRead(uint8_t) {
+  return pin_level;
+}
+
+int analogRead(uint8_t pin) {
+  return host_analog_hook ? host_analog_hook(pin) : 0;
+}
+
+void noInterrupts() {
+  irq_enabled = false;
+}
+
+// an edge that arrived while interrupts were disabled is serviced now
+void interrupts() {
+  irq_enabled = true;
+  if (irq_pending) {
+    irq_pending = false;
+    if (pin_isr) {
+      pin_isr();
+    }
+  }
+}
+
+void attachInterrupt(uint8_t, void (*isr)(), int) {
+  pin_isr = isr;
+}
+
+void detachInterrupt(uint8_t) {
+  pin_isr = NULL;
+}
+
+long random(long max) {
+  return max > 0 ? rand() % max : 0;
+}
+
+long random(long min, long max) {
+  return min + random(max - min);
+}
+
+void randomSeed(unsigned long seed) {
+  srand(seed);
+}
+
+uint64_t host_time_us() {
+  return now_us;
+}
+
+// move the clock forward, servicing any pin edges along the way
+void host_advance(uint32_t us) {
+  uint64_t until = now_us + us;
+
+  while (edge_head != edge_tail && edges[edge_head].at_us <= until) {
+    if (edges[edge_head].at_us > now_us) {
+      now_us = edges[edge_head].at_us;
+    }
+    pin_level = edges[edge_head].level;
+    edge_head = (edge_head + 1) % MAX_EDGES;
+
+    if (host_edge_hook) {
+      host_edge_hook(now_us, pin_level);
+    }
+
+    if (irq_enabled) {
+      if (pin_isr) {
+        pin_isr();
+      }
+    } else {
+      irq_pending = true;
+    }
+  }
+  now_us = until;
+}
+
+// move the clock forward with interrupts disabled, as happens while the LEDs are being shown.
+// some libraries also cause millis() and micros() to lose that time; set halt_clock to model that.
+void host_blackout(uint32_t us, bool halt_clock) {
+  bool was_enabled = irq_enabled;
+
+  irq_enabled = false;
+  host_advance(us);
+  if (halt_clock) {
+    halted_us += us;
+  }
+  if (was_enabled) {
+    interrupts();
+  }
+}
+
+// queue an edge on the hilt data pin; edges must be queued in time order
+void host_pin_edge(uint64_t at_us, uint8_t level) {
+  uint32_t next = (edge_tail + 1) % MAX_EDGES;
+
+  if (next != edge_head) {
+    edges[edge_tail].at_us = at_us;
+    edges[edge_tail].level = level;
+    edge_tail = next;
+  }
+}
+
+uint32_t host_pending_edges() {
+  return (edge_tail + MAX_EDGES - edge_head) % MAX_EDGES;
+}
+
+// time from the edge that wakes the MCU to its interrupt being serviced
+uint32_t host_wake_us = 0;
+
+// sleep until the next edge on the hilt data pin; returns straight away if none is queued
+void host_sleep() {
+  uint64_t wake;
+
+  if (edge_head == edge_tail) {
+    return;
+  }
+  wake = edges[edge_head].at_us + host_wake_us;
+  host_blackout((wake > now_us) ? (uint32_t)(wake - now_us) : 0, true);
+}
+
+HostEEPROM::HostEEPROM() {
+  memset(data, 0xFF, sizeof(data));
+  memset(writes, 0, sizeof(writes));
+}
+
+void HostEEPROM::write(int idx, uint8_t val) {
+  if (data[idx] != val) {
+    data[idx] = val;
+    writes[idx]++;
+    host_advance(HOST_EEPROM_WRITE_US);
+  }
+}
+
+// total writes that changed a byte; if most isn't NULL, it's set to the most any one byte has had
+uint32_t host_eeprom_writes(uint32_t *most) {
+  uint32_t total = 0, max = 0;
+
+  for (int i = 0; i < HOST_EEPROM_LEN; i++) {
+    total += EEPROM.writes[i];
+    max = (EEPROM.writes[i] > max) ? EEPROM.writes[i] : max;
+  }
+  if (most) {
+    *most = max;
+  }
+  return total;
+}
+
+// fill the EEPROM from a file; anything past the end of the file stays as it was
+bool host_eeprom_load(const char *path) {
+  FILE *f = fopen(path, "rb");
+  bool ok;
+
+  if (!f) {
+    return false;
+  }
+  ok = fread(EEPROM.data, 1, sizeof(EEPROM.data), f) > 0;
+  fclose(f);
+  return ok;
+}
+
+bool host_eeprom_save(const char *path) {
+  FILE *f = fopen(path, "wb");
+  bool ok;
+
+  if (!f) {
+    return false;
+  }
+  ok = fwrite(EEPROM.data, 1, sizeof(EEPROM.data), f) == sizeof(EEPROM.data);
+  fclose(f);
+  return ok;
+}
@@ -0,0 +1,113 @@
+/* host_arduino.h
+ * Just enough of the Arduino API to build the blade controller natively for the host (HOST_BUILD).
+ *
+ * time is virtual. millis() and micros() report a simulated clock that only moves when the
+ * simulator advances it (host_advance()), so a run is fast, repeatable, and independent of the
+ * speed of the machine it's on.
+ *
+ * the hilt data pin is driven by queueing edges (host_pin_edge()). when the clock passes an edge
+ * the interrupt attached to the pin is called, unless interrupts are disabled (as they are while
+ * the LEDs are being shown) in which case it is called once when interrupts are enabled again,
+ * just as a real MCU would with a single pending interrupt flag.
+ *
+ * hardware_sleep() calls host_sleep(), which sleeps until the next queued edge, as a blade
+ * waiting on the hilt would. the clock behind millis() and micros() stops while asleep, as
+ * timer 0 does in an AVR's power down sleep. interrupts stay off for host_wake_us after the edge,
+ * while the MCU starts back up.
+ *
+ * analogRead() returns whatever host_analog_hook returns for the pin, or 0 if it isn't set, so
+ * a program can script the voltage on any analog pin against the virtual clock.
+ */
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef uint8_t byte;
+
+#define HIGH          1
+#define LOW           0
+#define INPUT         0
+#define OUTPUT        1
+#define INPUT_PULLUP  2
+#define CHANGE        1
+#define DEC           10
+#define HEX           16
+
+// analog pins, numbered as on an Arduino Nano
+#define A0            14
+#define A1            15
+#define A2            16
+#define A3            17
+#define A4            18
+#define A5            19
+#define A6            20
+#define A7            21
+
+#define PROGMEM
+#define F(s)                    (s)
+#define pgm_read_byte(p)        (*(const uint8_t *)(p))
+#define pgm_read_word(p)        (*(const uint16_t *)(p))
+#define pgm_read_dword(p)       (*(const uint32_t *)(p))
+#define pgm_read_ptr(p)         (*(const void * const *)(p))
+#define digitalPinToInterrupt(p) (p)
+
+// Arduino API
+uint32_t millis();                      // 32 bits, like on the MCUs, so wrap-around behaves the same
+uint32_t micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t value);
+int digitalRead(uint8_t pin);
+int analogRead(uint8_t pin);
+void noInterrupts();
+void interrupts();
+void attachInterrupt(uint8_t interrupt, void (*isr)(), int mode);
+void detachInterrupt(uint8_t interrupt);
+long random(long max);
+long random(long min, long max);
+void randomSeed(unsigned long seed);
+
+// serial output goes to stderr
+class HostSerial {
+  public:
+    void begin(unsigned long) {}
+    int availableForWrite() { return 64; }
+    size_t write(uint8_t b) { return fputc(b, stderr) == EOF ? 0 : 1; }
+    size_t write(const uint8_t *buf, size_t n) { return fwrite(buf, 1, n, stderr); }
+    void print(const char *s) { fputs(s, stderr); }
+    void print(long v, int base = DEC) { fprintf(stderr, base == HEX ? "%lX" : "%ld", v); }
+    void println() { fputc('\n', stderr); }
+    void println(const char *s) { print(s); println(); }
+    void println(long v, int base = DEC) { print(v, base); println(); }
+};
+extern HostSerial Serial;
+
+// the benchmark markers in bench.h write to GPIOR0; on the host every write is passed to
+// host_marker() so the simulator can follow along
+class HostMarker {
+  public:
+    HostMarker &operator=(uint8_t v);
+};
+extern HostMarker GPIOR0;
+extern void (*host_marker)(uint8_t marker);
+
+// simulator controls
+uint64_t host_time_us();
+void host_advance(uint32_t us);
+void host_blackout(uint32_t us, bool halt_clock);
+void host_pin_edge(uint64_t at_us, uint8_t level);
+uint32_t host_pending_edges();
+void host_sleep();
+extern uint32_t host_wake_us;
+
+// called for every edge on the hilt data pin at the time it happens, whether or not interrupts
+// are enabled; used to model capture hardware that keeps timing pulses while the CPU is busy
+extern void (*host_edge_hook)(uint64_t at_us, uint8_t level);
+
+// called by analogRead(); returns the 10-bit reading for the pin
+extern int (*host_analog_hook)(uint8_t pin);
@@ -0,0 +1,67 @@
+/* host_leds.cpp
+ */
+#include "host_leds.h"
+
+#define SHOW_US_PER_LED   30      // WS2812B take 30us per pixel at 800KHz
+
+HostLEDs::HostLEDs(uint16_t n) : show_us_per_led(SHOW_US_PER_LED), show_us(0), show_halts_clock(false), n_pixels(n), brightness(255), dirty(true), n_frames(0), trace_file(NULL) {
+  pixels = (uint32_t *)calloc(n, sizeof(uint32_t));
+}
+
+HostLEDs::~HostLEDs() {
+  if (trace_file) {
+    fclose(trace_file);
+  }
+  free(pixels);
+}
+
+// same semantics as Adafruit NeoPixel: a count of 0 fills to the end of the strip
+void HostLEDs::fill(uint32_t c, uint16_t first, uint16_t count) {
+  uint16_t end;
+
+  if (first >= n_pixels) {
+    return;
+  }
+  end = (count == 0 || first + count > n_pixels) ? n_pixels : first + count;
+  while (first < end) {
+    pixels[first++] = c;
+  }
+  dirty = true;
+}
+
+// open a trace file; every call to show() from now on is recorded to it
+bool HostLEDs::trace(const char *path) {
+  static const uint16_t header[2] = { 1, 0 };
+
+  trace_file = fopen(path, "wb");
+  if (!trace_file) {
+    return false;
+  }
+  fwrite("GEBT", 1, 4, trace_file);
+  fwrite(&header[0], 2, 1, trace_file);
+  fwrite(&n_pixels, 2, 1, trace_file);
+  return true;
+}
+
+void HostLEDs::show() {
+  n_frames++;
+
+  if (trace_file) {
+    uint32_t ts = (uint32_t)host_time_us();
+    uint8_t flags = dirty ? 1 : 0;
+
+    fwrite(&ts, 4, 1, trace_file);
+    fwrite(&brightness, 1, 1, trace_file);
+    fwrite(&flags, 1, 1, trace_file);
+    if (dirty) {
+      for (uint16_t i = 0; i < n_pixels; i++) {
+        uint8_t rgb[3] = { (uint8_t)(pixels[i] >> 16), (uint8_t)(pixels[i] >> 8), (uint8_t)pixels[i] };
+        fwrite(rgb, 1, 3, trace_file);
+      }
+    }
+  }
+  dirty = false;
+
+  // the real libraries hold interrupts off while they push data out to the strip
+  host_blackout(show_us ? show_us : n_pixels * show_us_per_led, show_halts_clock);
+}
@@ -0,0 +1,51 @@
+/* host_leds.h
+ * LED backend for HOST_BUILD.
+ *
+ * offers the same API as Adafruit NeoPixel / tinyNeoPixel so hardware.h can treat it the same
+ * way. pixels are stored unscaled and brightness is applied when a frame is traced.
+ *
+ * show() takes SHOW_US_PER_LED of virtual time per pixel with interrupts disabled, like the real
+ * libraries, and if a trace file is open, appends the frame to it. show_us can stand in for a
+ * longer or shorter strip than NUM_LEDS when modelling how show() affects reading the hilt.
+ *
+ * TRACE FORMAT (little endian)
+ *   header: "GEBT", uint16 version (1), uint16 number of LEDs
+ *   frame:  uint32 timestamp in us, uint8 brightness, uint8 flags, [number of LEDs * 3 bytes of R, G, B]
+ *           flags bit 0 is set when pixel data follows; it is left out when no pixel changed since the last frame
+ */
+#pragma once
+
+#include "host_arduino.h"
+
+class HostLEDs {
+  public:
+    HostLEDs(uint16_t n);
+    ~HostLEDs();
+
+    static uint32_t Color(uint8_t r, uint8_t g, uint8_t b) { return ((uint32_t)r << 16) | ((uint32_t)g << 8) | b; }
+
+    void begin() {}
+    void show();
+    void clear() { memset(pixels, 0, n_pixels * sizeof(uint32_t)); dirty = true; }
+    void setPixelColor(uint16_t i, uint32_t c) { if (i < n_pixels) { pixels[i] = c; dirty = true; } }
+    uint32_t getPixelColor(uint16_t i) const { return i < n_pixels ? pixels[i] : 0; }
+    void fill(uint32_t c = 0, uint16_t first = 0, uint16_t count = 0);
+    void setBrightness(uint8_t b) { brightness = b; }
+    uint8_t getBrightness() const { return brightness; }
+    uint16_t numPixels() const { return n_pixels; }
+
+    // simulator controls
+    bool trace(const char *path);
+    uint32_t frames() const { return n_frames; }
+    uint32_t show_us_per_led;
+    uint32_t show_us;           // if not 0, show() takes this long regardless of the number of LEDs
+    bool show_halts_clock;      // millis() and micros() stop while show() runs (Adafruit NeoPixel)
+
+  private:
+    uint32_t *pixels;
+    uint16_t n_pixels;
+    uint8_t brightness;
+    bool dirty;
+    uint32_t n_frames;
+    FILE *trace_file;
+};
@@ -0,0 +1,110 @@
+/* hue.cpp
+ * Compare color_by_hsv() with the color_by_wheel() math it replaced.
+ *
+ * for every stock blade color the closest color each wheel can produce is found, to show how
+ * well wheel colors match the stock palette, and both conversions are timed over every hue.
+ * the timings are for the host CPU and only useful relative to each other; extras/simavr_bench's
+ * make hue times color_by_hsv() on an AVR.
+ *
+ * built with EXTRA=-DSPACE_SAVER, color_by_hsv() has to give the same color as the old math for
+ * every hue, or this exits with a non-zero status.
+ *
+ * usage: blade_hue [iterations]
+ */
+#include <time.h>
+#include "host_arduino.h"
+#include "hardware.h"
+#include "hsv.h"
+#include "blade_color_table.h"
+
+// color_by_wheel() before hsv.cpp; three evenly spaced, fully saturated segments
+static uint32_t legacy_wheel(uint8_t wheel) {
+  wheel = 255 - wheel;
+  if (wheel < 85) {
+    return LED_RGB(255 - wheel * 3, 0, wheel * 3);
+  } else if (wheel < 170) {
+    wheel -= 85;
+    return LED_RGB(0, wheel * 3, 255 - wheel * 3);
+  } else {
+    wheel -= 170;
+    return LED_RGB(wheel * 3, 255 - wheel * 3, 0);
+  }
+}
+
+static uint32_t hsv_wheel(uint8_t wheel) {
+  return color_by_hsv(wheel, 255, 255);
+}
+
+// largest difference of any one channel
+static int distance(uint32_t a, uint32_t b) {
+  int d = 0;
+  d = abs(LED_RGB_R(a) - LED_RGB_R(b));
+  d = (abs(LED_RGB_G(a) - LED_RGB_G(b)) > d) ? abs(LED_RGB_G(a) - LED_RGB_G(b)) : d;
+  d = (abs(LED_RGB_B(a) - LED_RGB_B(b)) > d) ? abs(LED_RGB_B(a) - LED_RGB_B(b)) : d;
+  return d;
+}
+
+// the hue on the given wheel closest to color, and how far off it is
+static int closest(uint32_t (*wheel)(uint8_t), uint32_t color, int *hue) {
+  int best = 256;
+
+  for (int h = 0; h < 256; h++) {
+    int d = distance(wheel(h), color);
+    if (d < best) {
+      best = d;
+      *hue = h;
+    }
+  }
+  return best;
+}
+
+static double time_ns(uint32_t (*wheel)(uint8_t), long iterations) {
+  struct timespec start, end;
+  volatile uint32_t sink = 0;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long i = 0; i < iterations; i++) {
+    sink = sink + wheel((uint8_t)i);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  return ((end.tv_sec - start.tv_sec) * 1e9 + (end.tv_nsec - start.tv_nsec)) / iterations;
+}
+
+int main(int argc, char *argv[]) {
+  long iterations = (argc > 1) ? atol(argv[1]) : 10000000;
+  static const struct { const char *name; uint32_t color; } stock[] = {
+    { "red",    RGB_BLADE_RED },
+    { "orange", RGB_BLADE_ORANGE },
+    { "yellow", RGB_BLADE_YELLOW },
+    { "green",  RGB_BLADE_GREEN },
+    { "cyan",   RGB_BLADE_CYAN },
+    { "blue",   RGB_BLADE_BLUE },
+    { "purple", RGB_BLADE_PURPLE }
+  };
+
+  printf("color\tlegacy_hue\tlegacy_error\thsv_hue\thsv_error\n");
+  for (unsigned i = 0; i < sizeof(stock) / sizeof(stock[0]); i++) {
+    int legacy_hue = 0, hsv_hue = 0;
+    int legacy_error = closest(legacy_wheel, stock[i].color, &legacy_hue);
+    int hsv_error = closest(hsv_wheel, stock[i].color, &hsv_hue);
+    printf("%s\t%d\t%d\t%d\t%d\n", stock[i].name, legacy_hue, legacy_error, hsv_hue, hsv_error);
+  }
+
+  printf("\nlegacy ns/call\t%.2f\n", time_ns(legacy_wheel, iterations));
+  printf("hsv ns/call\t%.2f\n", time_ns(hsv_wheel, iterations));
+
+  // SPACE_SAVER keeps the old hues, worked out without branches
+  #ifdef SPACE_SAVER
+    int mismatches = 0;
+
+    for (int h = 0; h < 256; h++) {
+      if (hsv_wheel(h) != legacy_wheel(h)) {
+        mismatches++;
+      }
+    }
+    printf("hues unlike the legacy wheel\t%d\t%s\n", mismatches, mismatches ? "FAIL" : "ok");
+    return mismatches ? 1 : 0;
+  #else
+    return 0;
+  #endif
+}
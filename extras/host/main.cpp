@@ -0,0 +1,198 @@
+/* main.cpp
+ * Blade controller simulator for HOST_BUILD.
+ *
+ * runs the sketch's setup() and loop() against a virtual clock and the HostLEDs backend, feeding
+ * it hilt commands from a script. commands are sent as real pulses on the simulated data pin so
+ * they go through read_cmd() just as they would on a blade, unless -d is given in which case they
+ * are written straight to hilt_cmd.
+ *
+ * usage: blade_sim [options] <script>
+ *   -t <file>   write a binary trace of every frame shown (see host_leds.h for the format)
+ *   -l <us>     virtual time each pass of loop() takes (default 20)
+ *   -s <us>     virtual time show() takes per LED (default 30)
+ *   -r <n>      play the script n times back to back (default 1)
+ *   -d          deliver commands directly to hilt_cmd rather than through the data pin
+ *   -e <file>   keep the simulated EEPROM in a file (see EEPROM.h); it's loaded before starting,
+ *               if the file exists, and saved back when the run is done
+ *
+ * the script has one command per line: <time in ms> <command byte>, e.g. "100 0x21".
+ * lines starting with # are ignored. the same scripts work with extras/simavr_bench.
+ *
+ * when the run is done a summary is printed to stdout.
+ */
+#include <time.h>
+#include <errno.h>
+#include <vector>
+#include "host_arduino.h"
+#include "EEPROM.h"
+#include "hardware.h"
+#include "hilt_cmd.h"
+#include "bench.h"
+#include "pattern.h"
+
+// hilt protocol timings in microseconds; a short LOW period is a 1 bit, a long one a 0 bit
+#define PREAMBLE_US     16400
+#define BIT_ONE_US      1200
+#define BIT_ZERO_US     2400
+#define BIT_HIGH_US     1200
+
+void setup();
+void loop();
+
+typedef struct {
+  uint64_t at_us;
+  uint8_t cmd;
+} script_cmd_t;
+
+static uint32_t decoded = 0;
+static uint32_t patterns[4];
+static uint64_t armed_us = 0;       // virtual time setup() armed command capture; the host clock starts at setup()
+
+// follow the benchmark markers written by the sketch
+static void on_marker(uint8_t marker) {
+  if (marker == BENCH_CMD_DECODED) {
+    decoded++;
+  } else if (marker == BENCH_ARMED) {
+    armed_us = host_time_us();
+  } else if ((marker & 0xF0) == BENCH_PATTERN) {
+    patterns[marker & 3]++;
+  }
+}
+
+// queue the pulses for one command starting at the given time
+static void send_pulses(uint64_t t, uint8_t cmd) {
+  host_pin_edge(t, LOW);
+  t += PREAMBLE_US;
+  host_pin_edge(t, HIGH);
+  t += PREAMBLE_US;
+  host_pin_edge(t, LOW);
+  t += PREAMBLE_US;
+  host_pin_edge(t, HIGH);
+  t += BIT_HIGH_US;
+
+  for (int i = 7; i >= 0; i--) {
+    host_pin_edge(t, LOW);
+    t += ((cmd >> i) & 1) ? BIT_ONE_US : BIT_ZERO_US;
+    host_pin_edge(t, HIGH);
+    t += BIT_HIGH_US;
+  }
+}
+
+static bool load_script(const char *path, std::vector<script_cmd_t> &script) {
+  FILE *f = fopen(path, "r");
+  char line[128];
+
+  if (!f) {
+    return false;
+  }
+  while (fgets(line, sizeof(line), f)) {
+    unsigned long ms;
+    int cmd;
+
+    if (line[0] != '#' && sscanf(line, "%lu %i", &ms, &cmd) == 2) {
+      script_cmd_t c = { (uint64_t)ms * 1000, (uint8_t)cmd };
+      script.push_back(c);
+    }
+  }
+  fclose(f);
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  std::vector<script_cmd_t> script;
+  const char *trace = NULL;
+  const char *eeprom = NULL;
+  uint32_t loop_us = 20;
+  uint32_t repeat = 1;
+  bool direct = false;
+  uint64_t passes = 0, end_us, offset_us = 0;
+  uint32_t sent = 0, runs, most_writes;
+  size_t next = 0;
+  int opt;
+  clock_t started;
+  double elapsed;
+
+  for (opt = 1; opt < argc - 1; opt++) {
+    if (!strcmp(argv[opt], "-t")) {
+      trace = argv[++opt];
+    } else if (!strcmp(argv[opt], "-l")) {
+      loop_us = strtoul(argv[++opt], NULL, 0);
+    } else if (!strcmp(argv[opt], "-s")) {
+      LED_OBJ.show_us_per_led = strtoul(argv[++opt], NULL, 0);
+    } else if (!strcmp(argv[opt], "-r")) {
+      repeat = strtoul(argv[++opt], NULL, 0);
+    } else if (!strcmp(argv[opt], "-d")) {
+      direct = true;
+    } else if (!strcmp(argv[opt], "-e")) {
+      eeprom = argv[++opt];
+    } else {
+      break;
+    }
+  }
+  if (opt != argc - 1 || !load_script(argv[opt], script) || script.empty()) {
+    fprintf(stderr, "usage: %s [-t trace] [-l loop_us] [-s show_us_per_led] [-r repeat] [-d] [-e eeprom] <script>\n", argv[0]);
+    return 1;
+  }
+  if (trace && !LED_OBJ.trace(trace)) {
+    perror(trace);
+    return 1;
+  }
+  if (eeprom && !host_eeprom_load(eeprom) && errno != ENOENT) {
+    perror(eeprom);
+    return 1;
+  }
+
+  // each repeat of the script starts a second after the previous one's last command
+  end_us = script.back().at_us + 1000000;
+  runs = repeat;
+
+  host_marker = on_marker;
+  started = clock();
+  setup();
+  while (host_time_us() < end_us * runs) {
+
+    // deliver (or queue the pulses for) any commands that are due
+    while (next < script.size() && script[next].at_us + offset_us <= host_time_us() + (direct ? 0 : PREAMBLE_US * 4)) {
+      if (direct) {
+        hilt_cmd = script[next].cmd;
+        decoded++;
+      } else {
+        send_pulses(script[next].at_us + offset_us, script[next].cmd);
+      }
+      sent++;
+      if (++next == script.size() && --repeat > 0) {
+        next = 0;
+        offset_us += end_us;
+      }
+    }
+
+    loop();
+    host_advance(loop_us);
+    passes++;
+  }
+  elapsed = (double)(clock() - started) / CLOCKS_PER_SEC;
+
+  printf("virtual time (ms)\t%llu\n", (unsigned long long)(host_time_us() / 1000));
+  printf("loop passes\t%llu\n", (unsigned long long)passes);
+  printf("frames shown\t%u\n", LED_OBJ.frames());
+  printf("commands sent\t%u\n", sent);
+  printf("commands decoded\t%u\n", decoded);
+  printf("boot to armed (us)\t%llu\n", (unsigned long long)armed_us);
+  #ifdef COMMAND_PATTERNS
+    printf("blaster patterns\t%u\n", patterns[PATTERN_BLASTER]);
+    printf("lockup patterns\t%u\n", patterns[PATTERN_LOCKUP]);
+    printf("drag patterns\t%u\n", patterns[PATTERN_DRAG]);
+  #endif
+  printf("eeprom writes\t%u\n", host_eeprom_writes(&most_writes));
+  printf("eeprom writes, most to one byte\t%u\n", most_writes);
+  printf("wall time (s)\t%.3f\n", elapsed);
+  if (elapsed > 0) {
+    printf("frames per second\t%.0f\n", LED_OBJ.frames() / elapsed);
+    printf("passes per second\t%.0f\n", passes / elapsed);
+  }
+  if (eeprom && !host_eeprom_save(eeprom)) {
+    perror(eeprom);
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,20 @@
+#!/bin/sh
+# build blade_noise with UNSTABLE_BLADE for several strip lengths and run each one
+#
+# usage: noise.sh [frames]
+#
+# exits with a non-zero status if any strip length draws pixels outside the range noise.h promises
+#
+# the times here are for the host CPU. for AVR cycles, "make noise" in extras/simavr_bench runs the
+# sketch built for a Nano with UNSTABLE_BLADE under simavr and reports noise_frame() in cycles
+
+cd "$(dirname "$0")" || exit 1
+status=0
+
+printf "leds\tnoise_us_per_frame\tfill_us_per_frame\tnoise_ns_per_led\tmin_red\tmax_red\n"
+for leds in 30 79 144 250; do
+  build="build/noise-$leds"
+  make -s BUILD="$build" EXTRA="-DUNSTABLE_BLADE -DHOST_NUM_LEDS=$leds" "$build/blade_noise" >&2 || exit 1
+  "$build/blade_noise" "$@" || status=1
+done
+exit $status
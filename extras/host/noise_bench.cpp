@@ -0,0 +1,73 @@
+/* noise_bench.cpp
+ * Time noise_frame() against the plain fill a stable blade gets.
+ *
+ * prints one line: the number of LEDs, the time to draw one unstable blade frame and one plain
+ * fill, and the unstable frame's time per LED. the timings are for the host CPU and only useful
+ * relative to each other and across strip lengths; run noise.sh to get a line per strip length.
+ *
+ * also checks that the frame stays within the range noise.h promises: no pixel brighter than the
+ * blade color, and none dimmed by more than the value noise and crackle together allow.
+ *
+ * noise_frame() only exists in a build with UNSTABLE_BLADE; noise.sh builds it that way.
+ *
+ * usage: blade_noise [frames]
+ */
+#include <time.h>
+#include "host_arduino.h"
+#include "hardware.h"
+#include "noise.h"
+#include "blade_color_table.h"
+
+#ifdef UNSTABLE_BLADE
+
+static double elapsed_ns(struct timespec *start, struct timespec *end) {
+  return (end->tv_sec - start->tv_sec) * 1e9 + (end->tv_nsec - start->tv_nsec);
+}
+
+int main(int argc, char *argv[]) {
+  long frames = (argc > 1) ? atol(argv[1]) : 20000;
+  struct timespec start, end;
+  double noise_us, fill_us;
+  uint32_t color = RGB_BLADE_RED;
+  int lowest = 256, highest = 0;
+
+  // step the clock along as a blade would so every frame is a different one
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long f = 0; f < frames; f++) {
+    host_advance(FRAME_TIME * 1000);
+    noise_frame(color);
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  noise_us = elapsed_ns(&start, &end) / frames / 1000;
+
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  for (long f = 0; f < frames; f++) {
+    host_advance(FRAME_TIME * 1000);
+    LED_FILL(color + (f & 1));
+  }
+  clock_gettime(CLOCK_MONOTONIC, &end);
+  fill_us = elapsed_ns(&start, &end) / frames / 1000;
+
+  // how far the red channel strays from the blade color over a second of frames
+  for (long f = 0; f < 1000 / FRAME_TIME; f++) {
+    host_advance(FRAME_TIME * 1000);
+    noise_frame(color);
+    for (int i = 0; i < NUM_LEDS; i++) {
+      int red = LED_RGB_R(LED_OBJ.getPixelColor(i));
+      lowest = (red < lowest) ? red : lowest;
+      highest = (red > highest) ? red : highest;
+    }
+  }
+
+  printf("%d\t%.2f\t%.2f\t%.1f\t%d\t%d\n", NUM_LEDS, noise_us, fill_us, noise_us * 1000 / NUM_LEDS, lowest, highest);
+  return (highest > 255 || lowest < (255 * (256 - (255 >> NOISE_DEPTH_SHIFT) - NOISE_CRACKLE_MASK)) >> 8) ? 1 : 0;
+}
+
+#else
+
+int main() {
+  fprintf(stderr, "blade_noise needs a build with UNSTABLE_BLADE; see noise.sh\n");
+  return 1;
+}
+
+#endif
@@ -0,0 +1,42 @@
+#!/bin/sh
+# play ../simavr_bench/patterns.txt through blade_sim, built with COMMAND_PATTERNS and CLASH_FLASH
+# switched on in config.h, and check the blaster, lockup and drag patterns it recognizes
+#
+# usage: pattern.sh [times to play the script]
+#
+# prints what was expected and what was counted, and exits with a non-zero status if they differ
+# or any command was lost
+
+cd "$(dirname "$0")" || exit 1
+repeat="${1:-5}"
+build=build/pattern
+
+./config_sketch.sh "$build/sketch" COMMAND_PATTERNS CLASH_FLASH || exit 1
+make -s SKETCH="$build/sketch" BUILD="$build" "$build/blade_sim" >&2 || exit 1
+"$build/blade_sim" -r "$repeat" ../simavr_bench/patterns.txt > "$build/summary.tsv" || exit 1
+
+# what patterns.txt has in it, each time through
+awk -F '\t' -v repeat="$repeat" '
+  BEGIN {
+    expect["blaster patterns"] = repeat
+    expect["lockup patterns"] = 2 * repeat
+    expect["drag patterns"] = 2 * repeat
+    status = 0
+    printf "count\texpected\tgot\tresult\n"
+  }
+  $1 == "commands sent" { sent = $2 }
+  $1 == "commands decoded" { expect[$1] = sent }
+  $1 in expect {
+    ok = ($2 == expect[$1])
+    printf "%s\t%s\t%s\t%s\n", $1, expect[$1], $2, ok ? "ok" : "FAIL"
+    if (!ok) {
+      status = 1
+    }
+    seen++
+  }
+  END {
+    if (seen != 4) {
+      status = 1
+    }
+    exit status
+  }' "$build/summary.tsv"
@@ -0,0 +1,41 @@
+#!/bin/sh
+# check that the features that redraw the blade every FRAME_TIME ms don't cost any commands from
+# the hilt. blade_sim is built with each one switched on in config.h, for a couple of strip
+# lengths, and run against the benchmark script and a Kylo Ren session for the unstable blade; each
+# build has to decode as many commands as the same strip with none of them on
+#
+# usage: redraw.sh [times to play the script]
+#
+# prints a line per build and exits with a non-zero status if any of them decodes fewer commands
+
+cd "$(dirname "$0")" || exit 1
+repeat="${1:-20}"
+status=0
+
+printf "option\tleds\tscript\tdecoded\tstock\tresult\n"
+for leds in 79 144 250; do
+  for script in ../simavr_bench/script.txt ../simavr_bench/kylo.txt; do
+    stock=
+    for option in stock TEMPORAL_DITHER COLOR_CROSSFADE_TIME=400 UNSTABLE_BLADE CLASH_FLASH; do
+      build="build/redraw-${option%%=*}-$leds"
+      if [ "$option" = stock ]; then
+        ./config_sketch.sh "$build/sketch" || exit 1
+      else
+        ./config_sketch.sh "$build/sketch" "$option" || exit 1
+      fi
+      make -s SKETCH="$build/sketch" BUILD="$build" EXTRA="-DHOST_NUM_LEDS=$leds" "$build/blade_sim" >&2 || exit 1
+
+      decoded=$("$build/blade_sim" -r "$repeat" "$script" | awk -F '\t' '$1 == "commands decoded" { print $2 }')
+      if [ -z "$stock" ]; then
+        stock=$decoded
+      fi
+      result=ok
+      if [ "$decoded" -lt "$stock" ]; then
+        result=FAIL
+        status=1
+      fi
+      printf "%s\t%s\t%s\t%s\t%s\t%s\n" "$option" "$leds" "$(basename "$script")" "$decoded" "$stock" "$result"
+    done
+  done
+done
+exit $status
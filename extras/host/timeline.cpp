@@ -0,0 +1,182 @@
+/* timeline.cpp
+ * Check ignition and extinguish timing against the stock blade timings.
+ *
+ * the timings in stock_blade_config.cpp come from logic analyzer captures of stock blades and the
+ * hilt's sound effects are timed to match them. this drives every entry of the savi and legacy
+ * lightsaber tables through an ignite and an extinguish and, after every pass of loop(), compares
+ * how many LEDs are lit against what the stock timing says should be lit at that moment.
+ *
+ * a blade passes if the number of lit LEDs never runs ahead of, or lags behind, the stock timing
+ * by more than the tolerance (in ms). in MIRROR_MODE the second half of the strip has to match the
+ * first, pixel for pixel, on every pass, or the blade fails however good its timing. with EXTINGUISH_TAIL_LEN the LEDs in the fading tail count
+ * as lit, and the tail has to be gone by the end of the extinguish. with IGNITION_CURVES the stock
+ * timing is bent by each lightsaber's curve, worked out here in floating point rather than from the
+ * sketch's tables. the strip length, MIRROR_MODE, EXTINGUISH_TAIL_LEN and IGNITION_CURVES are
+ * compile time settings; timeline.sh builds and runs this for a number of combinations.
+ *
+ * usage: blade_timeline [tolerance_ms]
+ *
+ * prints one row per blade and phase, and exits with a non-zero status if any blade is out of tolerance
+ * or, in MIRROR_MODE, its halves ever differ.
+ */
+#include "host_arduino.h"
+#include "hardware.h"
+#include "hilt_cmd.h"
+#include "stock_blade_config.h"
+#include "curve.h"
+
+#define LOOP_US         20        // virtual time each pass of loop() takes
+#define SETTLE_MS       2000      // time between phases; more than COLOR_MODE_CHANGE_TIME so the color mode never changes
+
+void setup();
+void loop();
+
+static uint32_t mirror_errors;    // passes where the two halves of a mirrored strip didn't match
+
+// how many LEDs, counting from the base of the blade, are lit
+static uint16_t lit_leds() {
+  uint16_t lit = 0;
+  bool mirrored = true;
+
+  for (uint16_t i = 0; i < TARGET_MAX; i++) {
+    if (LED_OBJ.getPixelColor(i) != 0) {
+      lit++;
+    }
+    #ifdef MIRROR_MODE
+      if (LED_OBJ.getPixelColor((NUM_LEDS - 1) - i) != LED_OBJ.getPixelColor(i)) {
+        mirrored = false;
+      }
+    #endif
+  }
+  if (!mirrored) {
+    mirror_errors++;
+  }
+  return lit;
+}
+
+// LEDs that should be reached 'ms' into an animation that covers 'n' LEDs along 'curve' over 'duration' ms
+static int32_t along_curve(uint8_t curve, int32_t ms, int32_t duration, int32_t n) {
+  double t = (double)ms / duration;
+
+  if (ms <= 0) {
+    return 0;
+  }
+  if (ms >= duration) {
+    return n;
+  }
+  #ifdef IGNITION_CURVES
+    switch (curve) {
+      case CURVE_EASE_IN:     t = t * t; break;
+      case CURVE_EASE_OUT:    t = 1 - (1 - t) * (1 - t); break;
+      case CURVE_EASE_IN_OUT: t = t * t * (3 - 2 * t); break;
+    }
+  #endif
+  return (int32_t)(t * n);
+}
+
+// the curves are only in the lightsaber tables with IGNITION_CURVES
+#ifdef IGNITION_CURVES
+  #define IGNITION_CURVE(ls)    ((ls)->ignition_curve)
+  #define EXTINGUISH_CURVE(ls)  ((ls)->extinguish_curve)
+#else
+  #define IGNITION_CURVE(ls)    CURVE_LINEAR
+  #define EXTINGUISH_CURVE(ls)  CURVE_LINEAR
+#endif
+
+// expected LEDs lit at 'ms' into an ignition or extinguish
+static int32_t expected_leds(bool igniting, const stock_lightsaber_t *ls, int32_t ms) {
+  if (igniting) {
+    return along_curve(IGNITION_CURVE(ls), ms, TIME_DECODE(ls->ignition_time), TARGET_MAX);
+  }
+
+  // the dark part of the blade trails the start of the tail by EXTINGUISH_TAIL_LEN LEDs
+  #ifdef EXTINGUISH_TAIL_LEN
+    int32_t lit = TARGET_MAX + EXTINGUISH_TAIL_LEN - along_curve(EXTINGUISH_CURVE(ls), ms - TIME_DECODE(ls->extinguish_time_delay), TIME_DECODE(ls->extinguish_time), TARGET_MAX + EXTINGUISH_TAIL_LEN);
+    return (lit > TARGET_MAX) ? TARGET_MAX : lit;
+  #else
+    return TARGET_MAX - along_curve(EXTINGUISH_CURVE(ls), ms - TIME_DECODE(ls->extinguish_time_delay), TIME_DECODE(ls->extinguish_time), TARGET_MAX);
+  #endif
+}
+
+static void run_for(uint32_t ms) {
+  uint64_t until = host_time_us() + (uint64_t)ms * 1000;
+
+  while (host_time_us() < until) {
+    loop();
+    host_advance(LOOP_US);
+  }
+}
+
+// send a command and follow the blade until the animation should be long over; returns the
+// worst timing error seen, in ms. an error is measured as how far the clock would have to be
+// moved, either way, for the number of lit LEDs to be what the stock timing expects.
+static int32_t follow(uint8_t cmd, bool igniting, const stock_lightsaber_t *ls, int32_t tolerance) {
+  int32_t duration = igniting ? TIME_DECODE(ls->ignition_time) : TIME_DECODE(ls->extinguish_time_delay) + TIME_DECODE(ls->extinguish_time);
+  uint64_t start = host_time_us();
+  int32_t worst = 0;
+
+  hilt_cmd = cmd;
+  mirror_errors = 0;
+  while (host_time_us() < start + (uint64_t)(duration + 100) * 1000) {
+    int32_t ms, lit, err;
+
+    loop();
+    ms = (int32_t)((host_time_us() - start) / 1000);
+    lit = lit_leds();
+
+    // widen the window around 'ms' until the expected count covers what is lit
+    for (err = 0; err <= duration + 100; err++) {
+      int32_t a = expected_leds(igniting, ls, ms - err), b = expected_leds(igniting, ls, ms + err);
+      if ((lit >= a && lit <= b) || (lit <= a && lit >= b)) {
+        break;
+      }
+    }
+    if (err > worst) {
+      worst = err;
+    }
+    if (worst > tolerance * 4) {
+      break;
+    }
+    host_advance(LOOP_US);
+  }
+  return worst;
+}
+
+int main(int argc, char *argv[]) {
+  int32_t tolerance = (argc > 1) ? atoi(argv[1]) : 10;
+  int failures = 0;
+
+  setup();
+  run_for(SETTLE_MS);
+
+  printf("leds\tmirror\ttable\tindex\tphase\tduration_ms\tworst_error_ms\tmirror_errors\tresult\n");
+  for (uint8_t table = 0; table < 2; table++) {
+    const stock_lightsaber_t *lightsabers = table ? legacy_lightsaber : savi_lightsaber;
+
+    for (uint8_t i = 0; i < LIGHTSABER_TABLE_LEN; i++) {
+      const stock_lightsaber_t *ls = &lightsabers[i];
+
+      for (uint8_t phase = 0; phase < 2; phase++) {
+        bool igniting = (phase == 0);
+        uint8_t cmd = (igniting ? (table ? 0x30 : 0x20) : (table ? 0x50 : 0x40)) | i;
+        int32_t worst = follow(cmd, igniting, ls, tolerance);
+        int32_t duration = igniting ? TIME_DECODE(ls->ignition_time) : TIME_DECODE(ls->extinguish_time_delay) + TIME_DECODE(ls->extinguish_time);
+
+        #ifdef MIRROR_MODE
+          printf("%u\t1\t", NUM_LEDS);
+        #else
+          printf("%u\t0\t", NUM_LEDS);
+        #endif
+        bool ok = (worst <= tolerance && mirror_errors == 0);
+
+        printf("%s\t%u\t%s\t%d\t%d\t%u\t%s\n", table ? "legacy" : "savi", i, igniting ? "ignite" : "extinguish",
+          duration, worst, mirror_errors, ok ? "ok" : "FAIL");
+        if (!ok) {
+          failures++;
+        }
+        run_for(SETTLE_MS);
+      }
+    }
+  }
+  return failures ? 1 : 0;
+}
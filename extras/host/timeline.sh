@@ -0,0 +1,50 @@
+#!/bin/sh
+# build blade_timeline for several strip lengths, with and without MIRROR_MODE, an extinguish tail
+# and IGNITION_CURVES, and run each one. ENABLE_CLIPS is run once, for the 144 LEDs clip_data.cpp is
+# rendered for, so the Kylo Ren ignition clip is held to the stock timing too
+#
+# usage: timeline.sh [tolerance_ms]
+#
+# exits with a non-zero status if any blade, in any configuration, is out of tolerance or, when
+# mirrored, has halves that don't match
+
+cd "$(dirname "$0")" || exit 1
+status=0
+header=1
+
+# build and run one configuration; $1 names the build, the rest are passed in EXTRA
+timeline() {
+  build="build/timeline-$1"
+  shift
+  make -s BUILD="$build" EXTRA="$*" "$build/blade_timeline" >&2 || exit 1
+  "$build/blade_timeline" $tolerance > "$build/timeline.tsv" || status=1
+  if [ $header = 1 ]; then
+    cat "$build/timeline.tsv"
+    header=0
+  else
+    tail -n +2 "$build/timeline.tsv"
+  fi
+}
+
+tolerance="$1"
+for leds in 30 79 144 250; do
+  for mirror in 0 1; do
+    for tail in 0 8; do
+      for curves in 0 1; do
+        extra="-DHOST_NUM_LEDS=$leds"
+        if [ "$mirror" = 1 ]; then
+          extra="$extra -DMIRROR_MODE"
+        fi
+        if [ "$tail" != 0 ]; then
+          extra="$extra -DEXTINGUISH_TAIL_LEN=$tail"
+        fi
+        if [ "$curves" = 1 ]; then
+          extra="$extra -DIGNITION_CURVES"
+        fi
+        timeline "$leds-$mirror-$tail-$curves" $extra
+      done
+    done
+  done
+done
+timeline clips -DHOST_NUM_LEDS=144 -DENABLE_CLIPS
+exit $status
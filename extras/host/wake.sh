@@ -0,0 +1,12 @@
+#!/bin/sh
+# build blade_wake with a short SLEEP_AFTER and run it
+#
+# usage: wake.sh [cycles]
+#
+# exits with a non-zero status if wake_stats doesn't match what the blade was actually sent
+
+cd "$(dirname "$0")" || exit 1
+
+build="build/wake"
+make -s BUILD="$build" EXTRA="-DHOST_SLEEP_AFTER=500" "$build/blade_wake" >&2 || exit 1
+"$build/blade_wake" "$@"
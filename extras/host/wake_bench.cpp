@@ -0,0 +1,155 @@
+/* wake_bench.cpp
+ * Put the blade to sleep and wake it with a command, over and over, and check wake_stats.
+ *
+ * each cycle leaves the blade off until it goes to sleep (after SLEEP_AFTER), then wakes it with a
+ * savi's ignite command sent as pulses on the data pin, some random time later. the time the MCU
+ * takes to start back up (host_wake_us) is also random, up to WAKE_STARTUP_MAX_US. once the blade
+ * is lit it is extinguished and left to go back to sleep.
+ *
+ * what the blade counts in wake_stats is checked against what actually happened:
+ *
+ *   wakes           has to be one per cycle
+ *   first_cmd_ok    has to match the number of wakes whose ignite command was the first command
+ *                   decoded afterwards, within WAKE_CMD_WINDOW, and every wake has to be one
+ *   max_latency_us  wake to first frame; has to be within WAKE_CMD_WINDOW
+ *
+ * the pin interrupt path of read_cmd() is what's simulated; the TCB0 capture used on megaTinyCore
+ * isn't, though it wakes the same way, on a pin change, with TCB0 stopped while asleep. wake.sh builds this with a short SLEEP_AFTER so a run doesn't take
+ * hours of virtual time.
+ *
+ * usage: blade_wake [cycles]
+ *
+ * prints a summary and exits with a non-zero status if any check fails.
+ */
+#include "host_arduino.h"
+#include "hardware.h"
+#include "hilt_cmd.h"
+#include "blade.h"
+#include "bench.h"
+
+#ifdef WAKE_STATS
+
+#define LOOP_US               20        // virtual time each pass of loop() takes
+#define WAKE_STARTUP_MAX_US   4000      // most time the MCU takes to start back up after the waking edge
+#define WAKE_GAP_MAX_MS       3000      // most time, after falling asleep, before the next command
+
+// hilt protocol timings in microseconds; a short LOW period is a 1 bit, a long one a 0 bit
+#define PREAMBLE_US     16400
+#define BIT_ONE_US      1200
+#define BIT_ZERO_US     2400
+#define BIT_HIGH_US     1200
+
+void setup();
+void loop();
+
+static uint32_t decoded = 0;
+static uint8_t last_decoded = 0;
+
+static void on_marker(uint8_t marker) {
+  if (marker == BENCH_CMD_DECODED) {
+    decoded++;
+    last_decoded = hilt_cmd;
+  }
+}
+
+// queue the pulses for one command
+static void send_pulses(uint64_t t, uint8_t cmd) {
+  host_pin_edge(t, LOW);
+  t += PREAMBLE_US;
+  host_pin_edge(t, HIGH);
+  t += PREAMBLE_US;
+  host_pin_edge(t, LOW);
+  t += PREAMBLE_US;
+  host_pin_edge(t, HIGH);
+  t += BIT_HIGH_US;
+
+  for (int i = 7; i >= 0; i--) {
+    host_pin_edge(t, LOW);
+    t += ((cmd >> i) & 1) ? BIT_ONE_US : BIT_ZERO_US;
+    host_pin_edge(t, HIGH);
+    t += BIT_HIGH_US;
+  }
+}
+
+// run loop() until the blade reaches 'state', or 'ms' of virtual time passes; false if it timed out
+static bool run_until_state(blade_state_t state, uint32_t ms) {
+  uint64_t until = host_time_us() + (uint64_t)ms * 1000;
+
+  while (blade.state != state) {
+    if (host_time_us() >= until) {
+      return false;
+    }
+    loop();
+    host_advance(LOOP_US);
+  }
+  return true;
+}
+
+int main(int argc, char *argv[]) {
+  uint32_t cycles = (argc > 1) ? strtoul(argv[1], NULL, 0) : 1000;
+  uint32_t woke_ok = 0, stuck = 0, wakes, i;
+  bool ok;
+
+  srand(1);
+  host_marker = on_marker;
+  setup();
+  run_until_state(BLADE_OFF, 1000);
+
+  for (i = 0; i < cycles; i++) {
+    uint8_t cmd = 0x20 | (i % LIGHTSABER_TABLE_LEN);
+    uint32_t decoded_before;
+    uint64_t woke_at;
+
+    // the command is queued before the blade falls asleep, so it's what wakes the blade; the
+    // blade has to get to sleep well before it starts
+    wakes = wake_stats.wakes;
+    host_wake_us = random(WAKE_STARTUP_MAX_US + 1);
+    send_pulses(host_time_us() + (SLEEP_AFTER + 100 + random(WAKE_GAP_MAX_MS)) * 1000ULL, cmd);
+    while (wake_stats.wakes == wakes && host_pending_edges()) {
+      loop();
+      host_advance(LOOP_US);
+    }
+    woke_at = host_time_us();
+    decoded_before = decoded;
+
+    // the first command decoded after waking has to be the one that woke the blade
+    while (decoded == decoded_before && host_time_us() < woke_at + WAKE_CMD_WINDOW * 1000ULL) {
+      loop();
+      host_advance(LOOP_US);
+    }
+    if (decoded != decoded_before && last_decoded == cmd) {
+      woke_ok++;
+    }
+
+    // let it ignite, then put it out again
+    if (!run_until_state(BLADE_IDLE, 2000)) {
+      stuck++;
+    }
+    send_pulses(host_time_us(), 0x40 | (i % LIGHTSABER_TABLE_LEN));
+    if (!run_until_state(BLADE_OFF, 4000)) {
+      stuck++;
+    }
+  }
+
+  ok = wake_stats.wakes == cycles && wake_stats.first_cmd_ok == woke_ok && woke_ok == cycles && stuck == 0 &&
+       wake_stats.max_latency_us < WAKE_CMD_WINDOW * 1000UL;
+
+  printf("cycles\t%u\n", cycles);
+  printf("wakes\t%u\n", wake_stats.wakes);
+  printf("first_cmd_ok\t%u\n", wake_stats.first_cmd_ok);
+  printf("waking command decoded first\t%u\n", woke_ok);
+  printf("cycles that didn't ignite or extinguish\t%u\n", stuck);
+  printf("last_latency_us\t%u\n", wake_stats.last_latency_us);
+  printf("max_latency_us\t%u\n", wake_stats.max_latency_us);
+  printf("result\t%s\n", ok ? "ok" : "FAIL");
+  return ok ? 0 : 1;
+}
+
+#else
+
+int main() {
+  fprintf(stderr, "blade_wake needs a build with WAKE_STATS\n");
+  return 1;
+}
+
+#endif
@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+# profile_encode.py
+#
+# build the EEPROM image USER_PROFILES reads at boot (see profile.h in the sketch for the layout).
+#
+#   profile_encode.py [-a ADDR] [-b] [-s] [-e SIZE] [-j RECORDS] [-o FILE]
+#
+# options:
+#   -a ADDR   where in EEPROM the image starts; must match PROFILE_EEPROM_ADDR (default 0)
+#   -b        write a raw binary image, as loaded by extras/host's blade_sim -e, rather than Intel HEX
+#   -s        the blade is built with SPACE_SAVER, which keeps times in 4ms steps up to 1020ms
+#   -e SIZE   the EEPROM size in bytes (default 1024, an ATmega328P's; an ATtiny806's is 128)
+#   -j RECORDS  the blade is built with REMEMBER_COLOR and a journal of RECORDS records
+#             (JOURNAL_RECORDS, 16 by default); the journal has the end of the EEPROM
+#   -o FILE   where to write the image (default: profiles.eep, or profiles.bin with -b)
+#
+# the Intel HEX image can be written to a blade with avrdude, e.g.
+#
+#   avrdude -c arduino -p m328p -P /dev/ttyUSB0 -U eeprom:w:profiles.eep:i
+#
+# to change a lightsaber, add an entry to PROFILES below. "table" is "savi" or "legacy" and "index"
+# its position in that table in stock_blade_config.cpp. times are in ms; a time the blade can't
+# hold (over 1020ms with -s) is refused rather than letting the blade clamp it, and so is an image
+# that doesn't fit in the EEPROM in front of the journal.
+
+import struct
+import sys
+
+MAGIC = 0xB7
+VERSION = 1
+LEGACY = 0x10
+PROFILE_MAX = 4                 # only this many are kept by the blade; see PROFILE_MAX in profile.h
+TIME_MAX = 65535
+TIME_MAX_SPACE_SAVER = 1020     # see TIME_MAX in stock_blade_config.h
+JOURNAL_RECORD_LEN = 4          # see journal.h
+TIMES = ("ignition_time", "extinguish_time_delay", "extinguish_time")
+
+EFFECTS = {"none": 0, "unstable": 1}
+CURVES = {"linear": 0, "ease_in": 1, "ease_out": 2, "ease_in_out": 3}
+
+PROFILES = [
+    # savi's index 9 is an unconfirmed red in the stock table; make it a crimson blade
+    {"table": "savi", "index": 9, "color": (192, 0, 16), "clash": (255, 255, 0),
+     "ignition_time": 240, "extinguish_time_delay": 830, "extinguish_time": 415,
+     "effect": "none", "ignition_curve": "ease_out", "extinguish_curve": "ease_in"},
+]
+
+
+def crc16(data):
+    crc = 0xFFFF
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def encode(profiles, time_max=TIME_MAX):
+    data = bytearray([MAGIC, VERSION, len(profiles)])
+    for p in profiles:
+        if not 0 <= p["index"] < 16:
+            raise ValueError("index must be 0 - 15")
+        for t in TIMES:
+            if not 0 <= p[t] <= time_max:
+                raise ValueError("%s %d is out of range; the blade keeps 0 - %dms" % (t, p[t], time_max))
+        number = p["index"] | (LEGACY if p["table"] == "legacy" else 0)
+        data += bytes([number]) + bytes(p["color"]) + bytes(p["clash"])
+        data += struct.pack("<HHH", *(p[t] for t in TIMES))
+        data += bytes([EFFECTS[p["effect"]], CURVES[p["ignition_curve"]], CURVES[p["extinguish_curve"]]])
+    data += struct.pack("<H", crc16(data))
+    return data
+
+
+def intel_hex(data, addr):
+    lines = []
+    for i in range(0, len(data), 16):
+        chunk = data[i:i + 16]
+        a = addr + i
+        record = bytes([len(chunk), a >> 8, a & 0xFF, 0]) + chunk
+        lines.append(":%s%02X" % (record.hex().upper(), -sum(record) & 0xFF))
+    lines.append(":00000001FF")
+    return "\n".join(lines) + "\n"
+
+
+def main(argv):
+    addr = 0
+    binary = False
+    time_max = TIME_MAX
+    size = 1024
+    journal = 0
+    out = None
+    args = list(argv[1:])
+    while args:
+        opt = args.pop(0)
+        if opt == "-a":
+            addr = int(args.pop(0), 0)
+        elif opt == "-b":
+            binary = True
+        elif opt == "-s":
+            time_max = TIME_MAX_SPACE_SAVER
+        elif opt == "-e":
+            size = int(args.pop(0), 0)
+        elif opt == "-j":
+            journal = int(args.pop(0), 0) * JOURNAL_RECORD_LEN
+        elif opt == "-o":
+            out = args.pop(0)
+        else:
+            sys.exit("usage: profile_encode.py [-a addr] [-b] [-s] [-e size] [-j records] [-o file]")
+
+    if len(PROFILES) > PROFILE_MAX:
+        print("warning: only the first %d profiles will be used" % PROFILE_MAX)
+    try:
+        data = encode(PROFILES, time_max)
+    except ValueError as e:
+        sys.exit("error: %s" % e)
+    if addr + len(data) > size - journal:
+        sys.exit("error: the image ends at %d, past %s at %d" %
+                 (addr + len(data), "the journal" if journal else "the end of the EEPROM", size - journal))
+    if binary:
+        with open(out or "profiles.bin", "wb") as f:
+            f.write(b"\xff" * addr + data)
+    else:
+        with open(out or "profiles.eep", "w") as f:
+            f.write(intel_hex(data, addr))
+    print("%d profiles, %d bytes" % (len(PROFILES), len(data)))
+
+
+if __name__ == "__main__":
+    main(sys.argv)
@@ -0,0 +1,299 @@
+/* bench.c
+ * Cycle benchmark for blade_manager(), SHOW_LEDS() and read_cmd() under the simavr AVR simulator.
+ *
+ * the sketch is built with ENABLE_BENCHMARK defined, which has it write marker values to GPIOR0
+ * (see bench.h). this program loads the resulting ELF into simavr, drives the hilt data pin with
+ * the commands listed in a script file, and records the cycle count of every marker write.
+ *
+ * results are written to stdout as a tab separated table, one row per metric:
+ *
+ *   metric   name                    count   min   avg   max     (all values in CPU cycles)
+ *
+ *   manager  <blade state>           passes of blade_manager() that began in that state
+ *   show     show                    calls to SHOW_LEDS(); how long interrupts may have been held off
+ *   cmd      period_latency          hilt data pulse ending (rising edge) to read_cmd() picking it up
+ *   cmd      decoded                 number of commands decoded (count column only)
+ *   boot     armed                   reset to setup() arming hilt command capture
+ *   frame    noise                   unstable blade frames drawn by noise_frame() (UNSTABLE_BLADE only)
+ *   anim     target                  LEDs an ignition or extinguish has reached, worked out each pass;
+ *                                    curve_leds() with IGNITION_CURVES, the stock division without
+ *   color    hue                     color_by_hsv() converting a color wheel hue to a color
+ *   pattern  <pattern>               blaster, lockup and drag patterns recognized (COMMAND_PATTERNS only; count column only)
+ *
+ * usage: bench <firmware.elf> <script> [mcu] [frequency]
+ *
+ * the script has one command per line: <time in ms> <command byte>, e.g. "100 0x21".
+ * lines starting with # are ignored. the simulation ends 1 second after the last command.
+ *
+ * simavr does not model the tinyAVR 0-series parts (ATtiny806/1606), so only classic AVRs
+ * such as the ATmega328P (Arduino Nano) can be benchmarked this way.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <simavr/sim_avr.h>
+#include <simavr/sim_elf.h>
+#include <simavr/avr_ioport.h>
+
+// keep these in sync with bench.h
+#define BENCH_END           0x00
+#define BENCH_MANAGER       0x40
+#define BENCH_SHOW_BEGIN    0x80
+#define BENCH_SHOW_END      0x81
+#define BENCH_CMD_PERIOD    0x90
+#define BENCH_CMD_DECODED   0x91
+#define BENCH_ARMED         0x92
+#define BENCH_NOISE_BEGIN   0xA0
+#define BENCH_NOISE_END     0xA1
+#define BENCH_TARGET_BEGIN  0xA2
+#define BENCH_TARGET_END    0xA3
+#define BENCH_HUE_BEGIN     0xA4
+#define BENCH_HUE_END       0xA5
+#define BENCH_PATTERN       0xB0
+
+#define GPIOR0_ADDR         0x3E      // GPIOR0 in data space on the ATmega328P
+#define HILT_PORT           'D'       // Arduino pin 2 on a Nano is PD2
+#define HILT_PIN            2
+
+// hilt protocol timings in microseconds; a short LOW period is a 1 bit, a long one a 0 bit
+#define PREAMBLE_US         16400
+#define BIT_ONE_US          1200
+#define BIT_ZERO_US         2400
+#define BIT_HIGH_US         1200
+
+#define MAX_EDGES           (1 << 16)
+#define NUM_STATES          16
+#define NUM_PATTERNS        4
+
+typedef struct {
+  uint64_t count;
+  uint64_t min;
+  uint64_t max;
+  uint64_t total;
+} stat_t;
+
+static const char *state_names[NUM_STATES] = {
+  "BLADE_UNINITIALIZED", "BLADE_OFF", "BLADE_IGNITING", "BLADE_ON", "BLADE_IDLE", "BLADE_CLASH",
+  "BLADE_EXTINGUISHING", "BLADE_REFRESH", "BLADE_FLICKER_LOW", "BLADE_FLICKER_HIGH"
+};
+
+static struct {
+  uint64_t cycle;
+  uint8_t level;
+} edges[MAX_EDGES];
+static int edge_count = 0;
+
+static stat_t manager_stats[NUM_STATES];
+static stat_t show_stats;
+static stat_t period_stats;
+static stat_t noise_stats;
+static stat_t target_stats;
+static stat_t hue_stats;
+static uint64_t decoded = 0;
+static stat_t armed_stats;
+static uint64_t patterns[NUM_PATTERNS];
+
+static const char *pattern_names[NUM_PATTERNS] = { "none", "blaster", "lockup", "drag" };
+
+static int manager_state = -1;
+static uint64_t manager_start = 0;
+static uint64_t show_start = 0;
+static uint64_t last_rise = 0;
+static uint64_t noise_start = 0;
+static uint64_t target_start = 0;
+static uint64_t hue_start = 0;
+
+static void stat_add(stat_t *s, uint64_t v) {
+  if (s->count == 0 || v < s->min) {
+    s->min = v;
+  }
+  if (v > s->max) {
+    s->max = v;
+  }
+  s->total += v;
+  s->count++;
+}
+
+static void stat_print(const char *metric, const char *name, const stat_t *s) {
+  printf("%s\t%s\t%llu\t%llu\t%llu\t%llu\n", metric, name,
+    (unsigned long long)s->count, (unsigned long long)s->min,
+    (unsigned long long)(s->count ? s->total / s->count : 0), (unsigned long long)s->max);
+}
+
+static void add_edge(uint64_t cycle, uint8_t level) {
+  if (edge_count < MAX_EDGES) {
+    edges[edge_count].cycle = cycle;
+    edges[edge_count].level = level;
+    edge_count++;
+  }
+}
+
+// queue up the edges for one command, starting at the given cycle; returns the cycle it ends on
+static uint64_t add_command(uint64_t cycle, uint8_t cmd, uint64_t cycles_per_us) {
+  int i;
+
+  // preamble: LOW, HIGH, LOW
+  add_edge(cycle, 0);
+  cycle += PREAMBLE_US * cycles_per_us;
+  add_edge(cycle, 1);
+  cycle += PREAMBLE_US * cycles_per_us;
+  add_edge(cycle, 0);
+  cycle += PREAMBLE_US * cycles_per_us;
+  add_edge(cycle, 1);
+  cycle += BIT_HIGH_US * cycles_per_us;
+
+  // 8 bits, most significant first
+  for (i = 7; i >= 0; i--) {
+    add_edge(cycle, 0);
+    cycle += ((cmd >> i) & 1 ? BIT_ONE_US : BIT_ZERO_US) * cycles_per_us;
+    add_edge(cycle, 1);
+    cycle += BIT_HIGH_US * cycles_per_us;
+  }
+  return cycle;
+}
+
+// called by simavr whenever the firmware writes GPIOR0
+static void marker_write(avr_t *avr, avr_io_addr_t addr, uint8_t v, void *param) {
+  (void)param;
+  avr->data[addr] = v;
+
+  if (v == BENCH_END) {
+    if (manager_state >= 0) {
+      stat_add(&manager_stats[manager_state], avr->cycle - manager_start);
+      manager_state = -1;
+    }
+  } else if ((v & 0xC0) == BENCH_MANAGER) {
+    manager_state = v & (NUM_STATES - 1);
+    manager_start = avr->cycle;
+  } else if (v == BENCH_SHOW_BEGIN) {
+    show_start = avr->cycle;
+  } else if (v == BENCH_SHOW_END) {
+    stat_add(&show_stats, avr->cycle - show_start);
+  } else if (v == BENCH_CMD_PERIOD) {
+    stat_add(&period_stats, avr->cycle - last_rise);
+  } else if (v == BENCH_CMD_DECODED) {
+    decoded++;
+  } else if (v == BENCH_ARMED) {
+    stat_add(&armed_stats, avr->cycle);
+  } else if (v == BENCH_NOISE_BEGIN) {
+    noise_start = avr->cycle;
+  } else if (v == BENCH_NOISE_END) {
+    stat_add(&noise_stats, avr->cycle - noise_start);
+  } else if (v == BENCH_TARGET_BEGIN) {
+    target_start = avr->cycle;
+  } else if (v == BENCH_TARGET_END) {
+    stat_add(&target_stats, avr->cycle - target_start);
+  } else if (v == BENCH_HUE_BEGIN) {
+    hue_start = avr->cycle;
+  } else if (v == BENCH_HUE_END) {
+    stat_add(&hue_stats, avr->cycle - hue_start);
+  } else if ((v & 0xF0) == BENCH_PATTERN) {
+    patterns[v & (NUM_PATTERNS - 1)]++;
+  }
+}
+
+int main(int argc, char *argv[]) {
+  elf_firmware_t firmware;
+  const char *mcu = "atmega328p";
+  uint32_t frequency = 16000000;
+  uint64_t cycles_per_us, end_cycle = 0;
+  avr_t *avr;
+  avr_irq_t *hilt;
+  FILE *script;
+  char line[128];
+  int next_edge = 0, state, i;
+  stat_t decoded_stat;
+
+  if (argc < 3) {
+    fprintf(stderr, "usage: %s <firmware.elf> <script> [mcu] [frequency]\n", argv[0]);
+    return 1;
+  }
+  if (argc > 3) {
+    mcu = argv[3];
+  }
+  if (argc > 4) {
+    frequency = strtoul(argv[4], NULL, 0);
+  }
+  cycles_per_us = frequency / 1000000;
+
+  // build the hilt data waveform from the script
+  script = fopen(argv[2], "r");
+  if (!script) {
+    perror(argv[2]);
+    return 1;
+  }
+  while (fgets(line, sizeof(line), script)) {
+    unsigned long ms;
+    int cmd;
+
+    if (line[0] == '#' || sscanf(line, "%lu %i", &ms, &cmd) != 2) {
+      continue;
+    }
+    end_cycle = add_command(ms * 1000 * cycles_per_us, (uint8_t)cmd, cycles_per_us);
+  }
+  fclose(script);
+  end_cycle += 1000000 * cycles_per_us;
+
+  // load the firmware
+  memset(&firmware, 0, sizeof(firmware));
+  if (elf_read_firmware(argv[1], &firmware) != 0) {
+    fprintf(stderr, "unable to read %s\n", argv[1]);
+    return 1;
+  }
+  avr = avr_make_mcu_by_name(mcu);
+  if (!avr) {
+    fprintf(stderr, "simavr does not support %s\n", mcu);
+    return 1;
+  }
+  avr_init(avr);
+  avr->frequency = frequency;
+  avr_load_firmware(avr, &firmware);
+
+  avr_register_io_write(avr, GPIOR0_ADDR, marker_write, NULL);
+  hilt = avr_io_getirq(avr, AVR_IOCTL_IOPORT_GETIRQ(HILT_PORT), HILT_PIN);
+  avr_raise_irq(hilt, 1);   // the data line idles HIGH
+
+  // run until the script is done
+  do {
+    while (next_edge < edge_count && edges[next_edge].cycle <= avr->cycle) {
+      avr_raise_irq(hilt, edges[next_edge].level);
+      if (edges[next_edge].level) {
+        last_rise = avr->cycle;
+      }
+      next_edge++;
+    }
+    state = avr_run(avr);
+  } while (state != cpu_Done && state != cpu_Crashed && avr->cycle < end_cycle);
+
+  // report
+  printf("metric\tname\tcount\tmin\tavg\tmax\n");
+  for (i = 0; i < NUM_STATES; i++) {
+    if (manager_stats[i].count) {
+      stat_print("manager", state_names[i] ? state_names[i] : "UNKNOWN", &manager_stats[i]);
+    }
+  }
+  stat_print("boot", "armed", &armed_stats);
+  stat_print("show", "show", &show_stats);
+  stat_print("cmd", "period_latency", &period_stats);
+  memset(&decoded_stat, 0, sizeof(decoded_stat));
+  decoded_stat.count = decoded;
+  stat_print("cmd", "decoded", &decoded_stat);
+  if (noise_stats.count) {
+    stat_print("frame", "noise", &noise_stats);
+  }
+  if (target_stats.count) {
+    stat_print("anim", "target", &target_stats);
+  }
+  if (hue_stats.count) {
+    stat_print("color", "hue", &hue_stats);
+  }
+  for (i = 1; i < NUM_PATTERNS; i++) {
+    if (patterns[i]) {
+      memset(&decoded_stat, 0, sizeof(decoded_stat));
+      decoded_stat.count = patterns[i];
+      stat_print("pattern", pattern_names[i], &decoded_stat);
+    }
+  }
+
+  return state == cpu_Crashed ? 1 : 0;
+}
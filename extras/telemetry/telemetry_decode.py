@@ -0,0 +1,153 @@
+#!/usr/bin/env python3
+# telemetry_decode.py
+#
+# turn the binary debug event stream sent by a blade built with SERIAL_DEBUG_ENABLE back into
+# readable text. see telemetry.h and telemetry.cpp in the sketch for the format.
+#
+#   telemetry_decode.py /dev/ttyUSB0          read from a serial port (needs pyserial)
+#   telemetry_decode.py capture.bin           decode a capture saved to a file
+#   blade_sim script.txt 2>&1 >/dev/null | telemetry_decode.py -
+#                                             decode the serial output of the host build
+#
+# options:
+#   -b BAUD     serial port baud rate (default 115200, matching hardware_deferred_setup())
+
+import sys
+
+SYNC = 0xA5
+FRAME_LEN = 7
+BACKSTEP_MS = 4096              # a timestamp this close behind the last one is out of order, not a wrap
+
+# keep these in sync with telemetry.h
+EVENTS = {
+    0x01: "BOOT",
+    0x02: "READY",
+    0x03: "PROFILES",
+    0x10: "STATE",
+    0x11: "COLOR_MODE",
+    0x12: "WHEEL",
+    0x20: "CMD",
+    0x21: "REFRESH_BLOCKED",
+    0x22: "DEMO_RESTART",
+    0x23: "BIT_SPLIT",
+    0x24: "PATTERN",
+    0x30: "POWER_LIMIT",
+    0x31: "BATTERY_MV",
+    0x32: "BATTERY_RUNTIME",
+    0x40: "EFFECT_ERROR",
+    0x7F: "OVERFLOW",
+}
+
+# the command decoder statistics are sent one word per event, starting at id 0x50; keep these in
+# sync with cmd_stats_t in hilt_cmd.h
+CMD_HIST_BINS = 8
+CMD_STATS = ["DECODED", "CUTOFF_RESETS", "PREAMBLE_PULSES", "DONT_SHOW_TIMEOUTS", "REFRESH_BLOCKED"] \
+    + ["BIT1[%d]" % i for i in range(CMD_HIST_BINS)] \
+    + ["BIT0[%d]" % i for i in range(CMD_HIST_BINS)]
+for i, stat in enumerate(CMD_STATS):
+    EVENTS[0x50 + i] = "STAT_" + stat
+
+# keep these in sync with blade.h and pattern.h
+STATES = ["BLADE_UNINITIALIZED", "BLADE_OFF", "BLADE_IGNITING", "BLADE_ON", "BLADE_IDLE",
+          "BLADE_CLASH", "BLADE_EXTINGUISHING", "BLADE_REFRESH", "BLADE_FLICKER_LOW",
+          "BLADE_FLICKER_HIGH"]
+PATTERNS = ["NONE", "BLASTER", "LOCKUP", "DRAG"]
+COLOR_MODES = ["COLOR_MODE_STOCK", "COLOR_MODE_WHEEL_CYCLE", "COLOR_MODE_WHEEL_CYCLE_WHITE",
+               "COLOR_MODE_WHEEL_HOLD", "COLOR_MODE_WHEEL_HOLD_WHITE"]
+
+
+def lookup(table, value):
+    return table[value] if value < len(table) else "0x%02X" % value
+
+
+# how each event's payload is shown
+def describe(name, payload):
+    if name in ("STATE", "REFRESH_BLOCKED"):
+        return lookup(STATES, payload)
+    if name == "COLOR_MODE":
+        return lookup(COLOR_MODES, payload)
+    if name == "PATTERN":
+        return lookup(PATTERNS, payload)
+    if name == "CMD":
+        return "0x%02X" % payload
+    if name == "BOOT":
+        if payload == 0xFFFF:
+            return "655350 us or more to armed"
+        return "%d us to armed" % (payload * 10)
+    if name == "BATTERY_MV":
+        return "%d mV" % payload
+    if name == "BATTERY_RUNTIME":
+        return "%d min" % payload
+    if name == "OVERFLOW":
+        return "%d events lost" % payload
+    if name in ("READY", "DEMO_RESTART"):
+        return ""
+    return str(payload)
+
+
+def frames(read):
+    buf = bytearray()
+    while True:
+        data = read()
+        if not data:
+            return
+        buf += data
+
+        while len(buf) >= FRAME_LEN:
+            if buf[0] != SYNC or (sum(buf[1:6]) & 0xFF) != buf[6]:
+                # not a frame, or a damaged one; resync on the next sync byte
+                del buf[0]
+                continue
+            yield buf[1], buf[2] | (buf[3] << 8), buf[4] | (buf[5] << 8)
+            del buf[:FRAME_LEN]
+
+
+def open_input(path, baud):
+    if path == "-":
+        stream = sys.stdin.buffer
+        return lambda: stream.read1(256)
+    try:
+        import serial
+    except ImportError:
+        serial = None
+    if path.startswith("/dev/") or path.upper().startswith("COM"):
+        if serial is None:
+            sys.exit("reading from a serial port needs pyserial")
+        port = serial.Serial(path, baud)
+        return lambda: port.read(max(1, port.in_waiting))
+    f = open(path, "rb")
+    return lambda: f.read(256)
+
+
+def main(argv):
+    baud = 115200
+    args = list(argv[1:])
+    if len(args) >= 2 and args[0] == "-b":
+        baud = int(args[1])
+        args = args[2:]
+    if len(args) != 1:
+        sys.exit("usage: telemetry_decode.py [-b baud] <port | file | ->")
+
+    # the timestamps are 16 bit millis(); unwrap them assuming events are less than 65s apart. the
+    # blade never sends a timestamp older than the one before it, but one a little behind is taken
+    # as a step back rather than a wrap, so a single frame out of order can't add 65s to everything
+    # after it
+    last = None
+    now = 0
+    for event, payload, time in frames(open_input(args[0], baud)):
+        if last is not None:
+            step = (time - last) & 0xFFFF
+            now += step - 0x10000 if step > 0x10000 - BACKSTEP_MS else step
+        else:
+            now = time
+        last = time
+
+        name = EVENTS.get(event, "EVENT_0x%02X" % event)
+        print("%10.3f  %-22s %s" % (now / 1000.0, name, describe(name, payload)), flush=True)
+
+
+if __name__ == "__main__":
+    try:
+        main(sys.argv)
+    except KeyboardInterrupt:
+        pass
@@ -2,8 +2,13 @@
  */
 #include "hardware.h"
 #include "config.h"
+#include "battery.h"
+#include "hilt_cmd.h"
+#include "telemetry.h"
 
-#if defined(MEGATINYCORE) || defined(USE_ADAFRUIT_NEOPIXEL)
+#if defined(HOST_BUILD)
+  HostLEDs LED_OBJ = HostLEDs(NUM_LEDS);
+#elif defined(MEGATINYCORE) || defined(USE_ADAFRUIT_NEOPIXEL)
   #ifdef MEGATINYCORE
     byte LED_OBJ_array[NUM_LEDS * 3];
     tinyNeoPixel LED_OBJ = tinyNeoPixel(NUM_LEDS, LED_DATA_PIN, ADAFRUIT_LED_TYPE, LED_OBJ_array);
@@ -26,6 +31,34 @@
   bool dont_show = false;
 #endif
 
+#ifdef WAKE_STATS
+  wake_stats_t wake_stats;
+  static uint32_t wake_us = 0;          // micros() when the MCU last woke
+  static bool wake_cmd_pending = false; // waiting on the first command since waking
+  static bool wake_frame_pending = false; // waiting on the first frame since waking
+
+  // called when a command from the hilt has been decoded
+  void wake_stats_command() {
+    if (wake_cmd_pending) {
+      wake_cmd_pending = false;
+      if ((micros() - wake_us) < (WAKE_CMD_WINDOW * 1000UL)) {
+        wake_stats.first_cmd_ok++;
+      }
+    }
+  }
+
+  // called when a frame is sent to the LEDs
+  void wake_stats_frame() {
+    if (wake_frame_pending) {
+      wake_frame_pending = false;
+      wake_stats.last_latency_us = micros() - wake_us;
+      if (wake_stats.last_latency_us > wake_stats.max_latency_us) {
+        wake_stats.max_latency_us = wake_stats.last_latency_us;
+      }
+    }
+  }
+#endif
+
 // switch off power to the LEDs
 void led_power_off() {
   #ifdef SERIAL_DEBUG_ENABLE
@@ -75,37 +108,13 @@ void led_power_on() {
   }
 }
 
-// setup the hardware for the device
+// setup the hardware the blade needs to respond to the hilt
+//
+// this is called by setup() right after hilt command capture has been armed. keep it short; a
+// blade plugged into a hilt that is already on can receive a command within milliseconds of power
+// up. anything that only matters for power consumption belongs in hardware_deferred_setup().
 void harware_setup() {
 
-  // setup AVR microcontrollers
-  #if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_MEGAAVR)
-
-    // default all pins to INPUT_PULLUP mode in order to conserve power
-    for (uint8_t i = 0; i < NUM_DIGITAL_PINS; i++ ) {
-      pinMode(i, INPUT_PULLUP) ;
-    }
-
-    // set sleep mode
-    #if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_MEGAAVR)
-      #ifdef DO_NOT_SLEEP_PWR_DOWN
-        set_sleep_mode(SLEEP_MODE_ADC);
-      #else
-        set_sleep_mode(SLEEP_MODE_PWR_DOWN);
-      #endif
-    #endif
-
-    // Disable ADC - reduce power consumption
-    #if defined(ADCSRA) && defined(ADEN)
-      ADCSRA &= ~(1 << ADEN);
-    #endif
-
-    // Disable SPI - reduce power consumption
-    #if defined(SPCR) && defined(SPE)
-      SPCR &= ~(1 << SPE);
-    #endif
-  #endif
-
   // setup LED power switch
   #ifdef LED_PWR_SWITCH_PIN
     pinMode(LED_PWR_SWITCH_PIN, OUTPUT);
@@ -116,7 +125,7 @@ void harware_setup() {
   #ifdef MEGATINYCORE
     pinMode(LED_DATA_PIN, OUTPUT);
     LED_OBJ.updateLatch(LATCH_DELAY_US);
-  #elif defined(USE_ADAFRUIT_NEOPIXEL)
+  #elif defined(USE_ADAFRUIT_NEOPIXEL) || defined(HOST_BUILD)
     LED_OBJ.begin();
     #ifdef ADAFRUIT_TRINKET_M0
       dotstar.begin();
@@ -129,12 +138,63 @@ void harware_setup() {
     #endif
     FastLED.addLeds<FASTLED_LED_TYPE, LED_DATA_PIN, FASTLED_RGB_ORDER>(leds, NUM_LEDS);
   #endif
+
+  // the LEDs are cleared and shown by blade_manager() the first time it enters BLADE_OFF, unless
+  // a command from the hilt has already arrived by then, in which case it gets to the LEDs first
   LED_OBJ.clear();
-  SHOW_LEDS();
-  
-  // serial output for debug purposes
+}
+
+// setup the rest of the hardware
+//
+// called from loop() once the first command from the hilt has been handled, or after BOOT_DEFER_TIME
+// if the hilt is quiet. none of this is needed to ignite the blade.
+void hardware_deferred_setup() {
+
+  // setup AVR microcontrollers
+  #if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_MEGAAVR)
+
+    // default all unused pins to INPUT_PULLUP mode in order to conserve power
+    for (uint8_t i = 0; i < NUM_DIGITAL_PINS; i++ ) {
+      if (i == HILT_DATA_PIN || i == LED_DATA_PIN) {
+        continue;
+      }
+      #ifdef LED_PWR_SWITCH_PIN
+        if (i == LED_PWR_SWITCH_PIN) {
+          continue;
+        }
+      #endif
+      pinMode(i, INPUT_PULLUP) ;
+    }
+
+    // set sleep mode
+    #ifdef DO_NOT_SLEEP_PWR_DOWN
+      set_sleep_mode(SLEEP_MODE_ADC);
+    #else
+      set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    #endif
+
+    // Disable ADC - reduce power consumption; battery_sample() switches it back on for each reading
+    #if defined(ADCSRA) && defined(ADEN)
+      ADCSRA &= ~(1 << ADEN);
+    #elif defined(ADC0) && defined(ADC_ENABLE_bm)
+      ADC0.CTRLA &= ~ADC_ENABLE_bm;
+    #endif
+
+    // Disable SPI - reduce power consumption
+    #if defined(SPCR) && defined(SPE)
+      SPCR &= ~(1 << SPE);
+    #endif
+  #endif
+
+  // setup battery voltage sensing; this has to come after the pins are defaulted to INPUT_PULLUP
+  // as the pull-up would throw off the voltage divider
+  #ifdef BATTERY_SENSE_PIN
+    battery_setup();
+  #endif
+
+  // serial output for debug purposes; the events logged since power up go out from here on
   #ifdef SERIAL_DEBUG_ENABLE
-    Serial.begin(115200);
+    telemetry_begin();
   #endif
 }
 
@@ -179,5 +239,21 @@ void hardware_sleep() {
   #elif defined ARDUINO_ARCH_SAMD
 
     LowPower.sleep();
+
+  // the host build sleeps until the next edge on the data pin; see extras/host
+  #elif defined(HOST_BUILD)
+
+    host_sleep();
   #endif
+
+  #ifdef WAKE_STATS
+    wake_stats.wakes++;
+    wake_us = micros();
+    wake_cmd_pending = true;
+    wake_frame_pending = true;
+  #endif
+
+  // whatever the decoder had in progress before sleeping is stale, and the pulse that woke
+  // us was likely only partially measured; start decoding fresh from the next pulse
+  cmd_capture_resume();
 }
\ No newline at end of file
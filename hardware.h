@@ -12,17 +12,41 @@
  */
 #pragma once
 
+// the defines in config.h decide which LED library and blade geometry are used below, so make
+// sure they have been seen before anything in this file is evaluated
+#include "config.h"
+
 // define library-agnostic macros so the rest of the code can manage LEDs without having to know which
 // specific hardware library is being used.
 //
-// this first block is for tinyNeoPixel and Adafruit NeoPixel libraries which share the same API
-#if defined(MEGATINYCORE) || defined(USE_ADAFRUIT_NEOPIXEL)
+// HOST_BUILD compiles the code natively for the host computer (see extras/host) with a simulated
+// LED strip that shares its API with the NeoPixel libraries below
+#if defined(HOST_BUILD)
+  #include "host_leds.h"
+  #define LED_OBJ             leds
+  #define LED_RGB             LED_OBJ.Color
+  #define LED_RGB_TYPE        uint32_t
+  #define LED_SET_PIXEL(n, c) LED_OBJ.setPixelColor(n, c)     // n = pixel number, c = color
+  #define LED_GET_PIXEL(n)    LED_OBJ.getPixelColor(n)        // n = pixel number
+  #define LED_FILL(c)         LED_OBJ.fill(c)                 // c = color
+  #define LED_FILL_N(c, s, n) LED_OBJ.fill(c, s, n)           // c = color, s = starting LED, n = number of LEDs to fill
+  #define LED_RGB_R(c)        (uint8_t)((c) >> 16)            // red, green, and blue components of a color
+  #define LED_RGB_G(c)        (uint8_t)((c) >> 8)
+  #define LED_RGB_B(c)        (uint8_t)(c)
+  extern HostLEDs LED_OBJ;
+
+// this block is for tinyNeoPixel and Adafruit NeoPixel libraries which share the same API
+#elif defined(MEGATINYCORE) || defined(USE_ADAFRUIT_NEOPIXEL)
   #define LED_OBJ             leds
   #define LED_RGB             LED_OBJ.Color
   #define LED_RGB_TYPE        uint32_t
   #define LED_SET_PIXEL(n, c) LED_OBJ.setPixelColor(n, c)     // n = pixel number, c = color
+  #define LED_GET_PIXEL(n)    LED_OBJ.getPixelColor(n)        // n = pixel number
   #define LED_FILL(c)         LED_OBJ.fill(c)                 // c = color
   #define LED_FILL_N(c, s, n) LED_OBJ.fill(c, s, n)           // c = color, s = starting LED, n = number of LEDs to fill
+  #define LED_RGB_R(c)        (uint8_t)((c) >> 16)            // red, green, and blue components of a color
+  #define LED_RGB_G(c)        (uint8_t)((c) >> 8)
+  #define LED_RGB_B(c)        (uint8_t)(c)
 
   // we must use tinyNeoPixel for megaTinyCore
   //
@@ -60,7 +84,11 @@
   #define LED_RGB             CRGB
   #define LED_RGB_TYPE        CRGB
   #define LED_SET_PIXEL(n, c) leds[n] = c
+  #define LED_GET_PIXEL(n)    leds[n]
   #define LED_FILL(c)         fill_solid(leds, NUM_LEDS, c)
+  #define LED_RGB_R(c)        (c).r
+  #define LED_RGB_G(c)        (c).g
+  #define LED_RGB_B(c)        (c).b
 
   // Trinket M0 users also need a DotStar object defined to turn off the on-board DotStar LED.
   #ifdef ADAFRUIT_TRINKET_M0
@@ -139,8 +167,35 @@
   #undef SERIAL_DEBUG_ENABLE
 #endif
 
+// how long, in ms, after power up to wait for a first command from the hilt before finishing
+// the rest of the hardware setup anyways; the hilt sends a refresh about once a second while on
+#define BOOT_DEFER_TIME       1500
+
+// wake statistics
+//
+// every wake from sleep is counted along with how long it took to get the first frame out to the
+// LEDs and whether the command that woke the blade was actually decoded. these are useful when
+// tuning sleep modes; a wake that doesn't produce a command within WAKE_CMD_WINDOW ms is counted
+// as a miss (or the blade was woken by noise on the data line)
+#ifndef SPACE_SAVER
+  #define WAKE_STATS
+  #define WAKE_CMD_WINDOW     250     // ms; a preamble plus 8 bits is about 70ms
+
+  typedef struct {
+    uint16_t wakes;                   // number of times the MCU has woken from sleep
+    uint16_t first_cmd_ok;            // number of wakes where a command was decoded within WAKE_CMD_WINDOW
+    uint32_t last_latency_us;         // wake to first frame shown, of the most recent wake
+    uint32_t max_latency_us;          // wake to first frame shown, worst case seen
+  } wake_stats_t;
+
+  extern wake_stats_t wake_stats;
+  void wake_stats_command();
+  void wake_stats_frame();
+#endif
+
 // function prototypes
 void led_power_off();
 void led_power_on();
 void harware_setup();
+void hardware_deferred_setup();
 void hardware_sleep();
@@ -13,6 +13,8 @@
 #include "hilt_cmd.h"
 #include "config.h"
 #include "hardware.h"
+#include "bench.h"
+#include "telemetry.h"
 
 // global variable where decoded hilt command is stored
 uint8_t hilt_cmd = 0;
@@ -21,6 +23,65 @@ uint8_t hilt_cmd = 0;
 // picked up by read_cmd()
 volatile uint32_t cmd_pulse_period = 0;
 
+// command decoder statistics; see hilt_cmd.h
+#ifdef CMD_STATS
+  cmd_stats_t cmd_stats;
+
+  // count a bit period in one of the histograms, which covers periods from low up to high
+  static void cmd_stats_bin(uint16_t *hist, uint16_t period, uint16_t low, uint16_t high) {
+    uint8_t bin = (period < low) ? 0 : (period - low) / ((high - low + CMD_HIST_BINS - 1) / CMD_HIST_BINS);
+
+    if (bin >= CMD_HIST_BINS) {
+      bin = CMD_HIST_BINS - 1;
+    }
+    CMD_STAT_INC(hist[bin]);
+  }
+#endif
+
+// adaptive bit split
+//
+// the hilt sends a refresh command (0xA? or 0xB?) about once a second while the blade is on. the
+// first nibble of those is 1010 or 1011, so every refresh has both 0 and 1 bits in it and they are
+// a steady supply of known-good bit periods.
+//
+// while a command is being read, each bit period nudges a running average for its cluster, 1 or 0,
+// in a scratch copy. if the command turns out to be a refresh the scratch copies are kept, otherwise
+// they are thrown away; a bit misread as a 1 never pulls the 1 average toward the 0 bits. the split
+// is then the midpoint of the two averages, clamped to BIT_SPLIT_MIN .. BIT_SPLIT_MAX.
+//
+// it's all adds and shifts. periods are in TCB0 ticks with USE_AVR_EV_CAPT (up to 37500 at 20MHz)
+// so the averages are kept in 16 bits unsigned and the difference is taken in 32 bits.
+#ifdef ADAPTIVE_BIT_SPLIT
+  uint16_t cmd_bit_split = VALID_BIT_SPLIT;
+  static uint16_t bit1_avg = (VALID_BIT_SPLIT * 2) / 3;
+  static uint16_t bit0_avg = (VALID_BIT_SPLIT * 4) / 3;
+  static uint16_t bit1_next;
+  static uint16_t bit0_next;
+
+  // commit the averages of the command just read and move the split to their midpoint
+  static void cmd_bit_calibrate() {
+    uint16_t split;
+
+    bit1_avg = bit1_next;
+    bit0_avg = bit0_next;
+
+    split = ((uint32_t)bit1_avg + bit0_avg) >> 1;
+    if (split < BIT_SPLIT_MIN) {
+      split = BIT_SPLIT_MIN;
+    } else if (split > BIT_SPLIT_MAX) {
+      split = BIT_SPLIT_MAX;
+    }
+
+    if (split != cmd_bit_split) {
+      cmd_bit_split = split;
+      DEBUG_EVENT(TELEMETRY_BIT_SPLIT, split);
+    }
+  }
+#endif
+
+// set by cmd_capture_resume() to have read_cmd() throw away any partially read command
+static bool cmd_restart = false;
+
 // ISR responsible for determining the length of a pulse on the data line. 
 // TinyAVRs will use their event system while all other MCUs will use a more
 // generic approach.
@@ -74,6 +135,13 @@ void read_cmd() {
   static uint32_t last_pulse_time = 0;
   uint32_t period = 0;
 
+  // start over; we've just woken from sleep
+  if (cmd_restart) {
+    cmd_restart = false;
+    cmd = 0;
+    bPos = 0;
+  }
+
   // grab the current pulse period value. this is done while interrupts are disabled in order
   // to prevent any data loss from an interrupt triggering between these two operations.
   noInterrupts();
@@ -83,6 +151,7 @@ void read_cmd() {
 
   // if there's a new pulse detected
   if (period > 0) {
+    BENCH_MARK(BENCH_CMD_PERIOD);
 
     // record the time
     last_pulse_time = micros();
@@ -90,6 +159,14 @@ void read_cmd() {
     // if period was less than 4ms treat it as a good bit value
     if (period < VALID_BIT_CUTOFF) {
 
+      // start of a new command; calibrate against a scratch copy of the bit averages
+      #ifdef ADAPTIVE_BIT_SPLIT
+        if (bPos == 0) {
+          bit1_next = bit1_avg;
+          bit0_next = bit0_avg;
+        }
+      #endif
+
       // shift the bits in the cmd variable left by 1 to make room for the new bit
       cmd <<= 1;
 
@@ -101,9 +178,22 @@ void read_cmd() {
 
       // a LOW period greater than 2ms can be treated as a 0, otherwise it is a 0
       // analysis of GE hilts shows that typically 1200-1600uS = 0, 2400-3000uS = 1
-      // this value may need tweaking; see DEFINE near top of code
-      if (period < VALID_BIT_SPLIT) {      
+      // this value may need tweaking; see DEFINE near top of code, or ADAPTIVE_BIT_SPLIT
+      if (period < CMD_BIT_SPLIT) {      
         cmd++;
+        #ifdef ADAPTIVE_BIT_SPLIT
+          bit1_next += ((int32_t)period - bit1_next) >> BIT_SPLIT_SHIFT;
+        #endif
+        #ifdef CMD_STATS
+          cmd_stats_bin(cmd_stats.bit1, period, 0, VALID_BIT_SPLIT);
+        #endif
+      } else {
+        #ifdef ADAPTIVE_BIT_SPLIT
+          bit0_next += ((int32_t)period - bit0_next) >> BIT_SPLIT_SHIFT;
+        #endif
+        #ifdef CMD_STATS
+          cmd_stats_bin(cmd_stats.bit0, period, VALID_BIT_SPLIT, VALID_BIT_CUTOFF);
+        #endif
       }
 
       // if more than 7 bits have been recorded (8 bits), we have a good 8-bit command.
@@ -111,6 +201,15 @@ void read_cmd() {
 
         // store the 8-bit command to a global variable which will be picked up by loop() function
         hilt_cmd = cmd;
+        BENCH_MARK(BENCH_CMD_DECODED);
+        CMD_STAT_INC(cmd_stats.decoded);
+
+        // only learn from refresh commands
+        #ifdef ADAPTIVE_BIT_SPLIT
+          if ((cmd & 0xE0) == 0xA0) {
+            cmd_bit_calibrate();
+          }
+        #endif
 
         // disable dont_show
         #ifdef USE_DONT_SHOW
@@ -146,21 +245,28 @@ void read_cmd() {
       // will be 18750 (assuming you haven't changed that in config.h) which is 2ms longer than the expected
       // preamble length. this seemed like a good enough value to use and derriving it from an existing 
       // value rather than adding yet another seems like the way to go.
-      #ifdef USE_DONT_SHOW
-        if (period < VALID_BIT_SPLIT * 10) {
+      if (period < VALID_BIT_SPLIT * 10) {
+        CMD_STAT_INC(cmd_stats.preamble_pulses);
+        #ifdef USE_DONT_SHOW
           dont_show = true;
-        }
-      #endif
+        #endif
+      } else {
+        CMD_STAT_INC(cmd_stats.cutoff_resets);
+      }
     }
   }
 
-  // unset dont_show if it's set and it's been more than 10 times the value of VALID_BIT_SPLIT since
-  // we last saw a pulse; this is the same amount of time we consider the upper limit on a preamble
+  // unset dont_show if it's set and it's been more than 20 times the value of VALID_BIT_SPLIT since
+  // we last saw a pulse. the first preamble pulse is measured when the line goes HIGH, and the second
+  // one ends 32.8ms after that; a timeout any shorter would drop dont_show in the middle of the
+  // preamble and let a SHOW_LEDS() run over the second preamble pulse and the first few bits.
+  // micros() is what's compared, so this is in microseconds even with USE_AVR_EV_CAPT
   #ifdef USE_DONT_SHOW
-    if (dont_show && micros() - last_pulse_time > VALID_BIT_SPLIT * 10) {
+    if (dont_show && micros() - last_pulse_time > VALID_BIT_SPLIT_IN_US * 20) {
       dont_show = false;
       bPos = 0;
       cmd = 0;
+      CMD_STAT_INC(cmd_stats.dont_show_timeouts);
     }
   #endif
 
@@ -171,6 +277,22 @@ void read_cmd() {
 
 }
 
+// true while a command may be coming in from the hilt: the data line is LOW, which is how every
+// pulse of a command starts, or read_cmd() has seen a preamble or the first bits of a command.
+//
+// dont_show alone isn't enough for something that redraws the blade every few ms. the first
+// preamble pulse isn't seen until the line goes HIGH again 16.4ms later, and a SHOW_LEDS() that
+// starts in that time can hold off the pin interrupt long enough that the pulse is measured too
+// long to be a preamble. checking the line itself means nothing new is started once it goes LOW.
+bool cmd_incoming() {
+  #ifdef USE_DONT_SHOW
+    if (dont_show) {
+      return true;
+    }
+  #endif
+  return digitalRead(HILT_DATA_PIN) == LOW;
+}
+
 void cmd_capture_setup() {
   // setup DATA pin for hilt
   pinMode(HILT_DATA_PIN, INPUT_PULLUP);
@@ -186,6 +308,8 @@ void cmd_capture_setup() {
 
     TCB0.CTRLB = TCB_CNTMODE2_bm;   // set input capture mode to pulse-width measurement
 
+    TCB0.INTCTRL = TCB_CAPT_bm;     // interrupt on capture; this is what runs ISR(TCB0_INT_vect)
+
     TCB0.CTRLA = TCB_CLKSEL0_bm     // enable prescaler (CLK_PER/2), gives us more time to capture events
               | TCB_ENABLE_bm;      // enable TCB0
 
@@ -199,6 +323,17 @@ void cmd_capture_setup() {
   #endif
 }
 
+// called after waking from sleep. any pulse period recorded around the time the MCU went to sleep
+// or woke up can't be trusted, so throw it and any partially decoded command away. the preamble
+// that precedes every command is long enough (3 x 16.4ms) that the command which woke us will still
+// be decoded from its first bit.
+void cmd_capture_resume() {
+  noInterrupts();
+    cmd_pulse_period = 0;
+  interrupts();
+  cmd_restart = true;
+}
+
 #ifdef ENABLE_DEMO
 void cmd_demo() {
   static uint32_t next_action = 0;
@@ -214,11 +349,9 @@ void cmd_demo() {
   // is it time to perform the next action?
   if (next_action < millis()) {
 
-    #ifdef SERIAL_DEBUG_ENABLE
-      if (cmds_idx == 0) {
-        Serial.println(F("\n\n** (RE)STARTING DEMO **\n\n"));
-      }
-    #endif
+    if (cmds_idx == 0) {
+      DEBUG_EVENT(TELEMETRY_DEMO_RESTART, 0);
+    }
 
     hilt_cmd = cmds[cmds_idx++];
     next_action = millis() + 5000;
@@ -235,11 +368,8 @@ void cmd_demo() {
 // you can make a copy of this function and modify it to meet your needs
 void cmd_process_template(uint8_t cmd) {
 
-  // DEBUG: display decoded command to serial monitor
-  #ifdef SERIAL_DEBUG_ENABLE
-    Serial.print(F("CMD: 0x"));
-    Serial.println(cmd, HEX);
-  #endif
+  // DEBUG: log decoded command
+  DEBUG_EVENT(TELEMETRY_CMD, cmd);
 
   // identify command
   switch (cmd & 0xF0) {
@@ -2,7 +2,8 @@
  */
 #pragma once
 
-#include <stdint.h>
+// SPACE_SAVER, ADAPTIVE_BIT_SPLIT and USE_AVR_EV_CAPT below all come from config.h and hardware.h
+#include "hardware.h"
 
 // global variable where decoded hilt command is stored
 extern uint8_t hilt_cmd;
@@ -23,10 +24,58 @@ extern volatile uint32_t cmd_pulse_period;
   #define VALID_BIT_SPLIT   VALID_BIT_SPLIT_IN_US
 #endif
 
+// command decoder statistics
+//
+// every path through read_cmd() that throws a pulse or a partial command away is counted, along
+// with every command decoded and every refresh blade_process_command() refuses. the LOW periods
+// of every bit are also binned into a histogram for 1 bits (0 to VALID_BIT_SPLIT) and another for
+// 0 bits (VALID_BIT_SPLIT to VALID_BIT_CUTOFF). if either histogram has a lot of counts piled up
+// in the bins next to VALID_BIT_SPLIT the split is in the wrong place for that hilt.
+//
+// the counters stop at 0xFFFF rather than wrapping. with SERIAL_DEBUG_ENABLE they are sent out
+// with the debug events each time the blade turns off; see telemetry.h
+#ifndef SPACE_SAVER
+  #define CMD_STATS
+  #define CMD_HIST_BINS       8
+
+  typedef struct {
+    uint16_t decoded;                 // commands decoded
+    uint16_t cutoff_resets;           // periods too long to be a bit or a preamble; partial command discarded
+    uint16_t preamble_pulses;         // periods >= VALID_BIT_CUTOFF short enough to be a preamble
+    uint16_t dont_show_timeouts;      // dont_show was set but no pulse followed in time
+    uint16_t refresh_blocked;         // refresh commands ignored because the blade was busy
+    uint16_t bit1[CMD_HIST_BINS];     // LOW periods read as a 1 bit
+    uint16_t bit0[CMD_HIST_BINS];     // LOW periods read as a 0 bit
+  } cmd_stats_t;
+
+  extern cmd_stats_t cmd_stats;
+
+  #define CMD_STAT_INC(c)     do { if ((c) != 0xFFFF) (c)++; } while (0)
+#else
+  #define CMD_STAT_INC(c)
+#endif
+
+// adaptive bit split
+//
+// with ADAPTIVE_BIT_SPLIT defined the split between a 0 and a 1 bit is moved to the midpoint of
+// the 0 and 1 bit periods actually seen from the hilt. see read_cmd()
+#ifdef ADAPTIVE_BIT_SPLIT
+  #define BIT_SPLIT_MIN       (VALID_BIT_SPLIT - (VALID_BIT_SPLIT / 4))
+  #define BIT_SPLIT_MAX       (VALID_BIT_SPLIT + (VALID_BIT_SPLIT / 4))
+  #define BIT_SPLIT_SHIFT     3         // each bit moves its cluster's average 1/8th of the way toward it
+
+  extern uint16_t cmd_bit_split;
+  #define CMD_BIT_SPLIT       cmd_bit_split
+#else
+  #define CMD_BIT_SPLIT       VALID_BIT_SPLIT
+#endif
+
 #ifndef USE_AVR_EV_CAPT 
   void data_pin_interrupt();
 #endif
 
 void cmd_capture_setup();
+void cmd_capture_resume();
 void read_cmd();
+bool cmd_incoming();
 void cmd_demo();
\ No newline at end of file
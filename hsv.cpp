@@ -0,0 +1,102 @@
+/* hsv.cpp
+ *
+ * the hue of a color is looked up in a 256 entry table per channel held in program memory. the
+ * table is built by the compiler by blending, in a straight line, between the stock blade colors
+ * at the hues given in hsv.h. saturation and value are then a couple of 8x8 bit multiplies per
+ * channel; there are no branches, so every conversion takes the same time.
+ *
+ * with SPACE_SAVER the 768 byte table is left out and the hue is worked out with the simpler
+ * three segment math color_by_wheel() has always used; those hues don't pass through the stock
+ * colors. it's done without branches too: each channel is a ramp up to 255 and back down, 85 hues
+ * either side of where that channel peaks, and a ramp's clamp to 0 is a sign mask, not a compare.
+ *
+ * the conversion is marked with BENCH_HUE_BEGIN and BENCH_HUE_END; extras/simavr_bench's make hue
+ * times it on an AVR, with and without SPACE_SAVER.
+ */
+#include "hsv.h"
+#include "config.h"
+#include "lut.h"
+#include "bench.h"
+
+#ifndef SPACE_SAVER
+
+// the stock colors the hue table passes through, and where; keep in step with blade_color_table.h
+constexpr int hue_anchor_hue[8] = { HUE_RED, HUE_ORANGE, HUE_YELLOW, HUE_GREEN, HUE_CYAN, HUE_BLUE, HUE_PURPLE, 256 };
+constexpr uint8_t hue_anchor_rgb[8][3] = {
+  { 255,   0,   0 },    // RGB_BLADE_RED
+  { 255, 102,   0 },    // RGB_BLADE_ORANGE
+  { 152, 152,   0 },    // RGB_BLADE_YELLOW
+  {   0, 255,   0 },    // RGB_BLADE_GREEN
+  {   0, 152, 152 },    // RGB_BLADE_CYAN
+  {   0,   0, 255 },    // RGB_BLADE_BLUE
+  { 152,   0, 152 },    // RGB_BLADE_PURPLE
+  { 255,   0,   0 }     // RGB_BLADE_RED again, to close the wheel
+};
+
+// one channel of hue h, which lies between anchors n and n + 1
+constexpr uint8_t hue_blend(int h, int ch, int n) {
+  return (hue_anchor_rgb[n][ch] * (hue_anchor_hue[n + 1] - h) + hue_anchor_rgb[n + 1][ch] * (h - hue_anchor_hue[n])
+          + (hue_anchor_hue[n + 1] - hue_anchor_hue[n]) / 2) / (hue_anchor_hue[n + 1] - hue_anchor_hue[n]);
+}
+
+// find the anchors hue h lies between, starting the search at anchor n
+constexpr uint8_t hue_find(int h, int ch, int n) {
+  return (h < hue_anchor_hue[n + 1]) ? hue_blend(h, ch, n) : hue_find(h, ch, n + 1);
+}
+
+constexpr uint8_t hue_entry(int h, int ch) {
+  return hue_find(h, ch, 0);
+}
+
+static const uint8_t hue_table[3][256] PROGMEM = {
+  { LUT_256(hue_entry, 0) },
+  { LUT_256(hue_entry, 1) },
+  { LUT_256(hue_entry, 2) }
+};
+
+#else
+
+// 255 where d is 0, down 3 for each step either way, and 0 from 85 steps away on; d >> 15 is all
+// ones when d is negative, which takes the place of both an abs() and a max()
+static inline uint8_t hue_ramp(int16_t d) {
+  int16_t m = d >> 15;
+
+  d = 255 - 3 * ((d ^ m) - m);
+  return d & ~(d >> 15);
+}
+
+#endif
+
+LED_RGB_TYPE color_by_hsv(uint8_t hue, uint8_t sat, uint8_t val) {
+  uint8_t r, g, b;
+  uint8_t white = 255 - sat;
+  uint16_t scale = sat + 1;
+  LED_RGB_TYPE c;
+
+  BENCH_MARK(BENCH_HUE_BEGIN);
+
+  // red peaks at both ends of the reversed wheel, so it's two ramps that never overlap
+  #ifdef SPACE_SAVER
+    hue = 255 - hue;
+    r = hue_ramp(hue) + hue_ramp(hue - 255);
+    g = hue_ramp(hue - 170);
+    b = hue_ramp(hue - 85);
+  #else
+    r = pgm_read_byte(&hue_table[0][hue]);
+    g = pgm_read_byte(&hue_table[1][hue]);
+    b = pgm_read_byte(&hue_table[2][hue]);
+  #endif
+
+  // saturation; mix the hue with white. c * (sat + 1) / 256 is at most sat, so adding 255 - sat
+  // can't go over 255
+  r = ((r * scale) >> 8) + white;
+  g = ((g * scale) >> 8) + white;
+  b = ((b * scale) >> 8) + white;
+
+  // value
+  scale = val + 1;
+  c = LED_RGB((r * scale) >> 8, (g * scale) >> 8, (b * scale) >> 8);
+
+  BENCH_MARK(BENCH_HUE_END);
+  return c;
+}
@@ -0,0 +1,25 @@
+/* hsv.h
+ * Hue, saturation, and value to RGB.
+ *
+ * hue runs 0 to 255 around the color wheel: red, orange, yellow, green, cyan, blue, purple and
+ * back to red. rather than the evenly spaced, fully saturated hues of a textbook color wheel,
+ * the hues pass exactly through the stock blade colors in blade_color_table.h, so a hue picked
+ * off the wheel looks like the stock blade of that color.
+ *
+ *   HUE_RED 0, HUE_ORANGE 24, HUE_YELLOW 43, HUE_GREEN 85, HUE_CYAN 128, HUE_BLUE 170, HUE_PURPLE 213
+ *
+ * saturation 255 is the pure hue, 0 is white. value 255 is full brightness, 0 is off.
+ */
+#pragma once
+
+#include "hardware.h"
+
+#define HUE_RED         0
+#define HUE_ORANGE      24
+#define HUE_YELLOW      43
+#define HUE_GREEN       85
+#define HUE_CYAN        128
+#define HUE_BLUE        170
+#define HUE_PURPLE      213
+
+LED_RGB_TYPE color_by_hsv(uint8_t hue, uint8_t sat, uint8_t val);
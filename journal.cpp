@@ -0,0 +1,79 @@
+/* journal.cpp
+ */
+#include "journal.h"
+#include "blade.h"
+
+#ifdef REMEMBER_COLOR
+#include <EEPROM.h>
+
+#define JOURNAL_ADDR        (EEPROM.length() - JOURNAL_LEN)     // the journal is kept at the very end of the EEPROM
+
+static uint8_t journal_next;          // record the next save goes in
+static uint8_t journal_seq;           // sequence number of the newest record
+static uint8_t saved_mode = 0xFF;     // what the newest record holds; 0xFF if there isn't one
+static uint8_t saved_wheel;
+
+// erased EEPROM reads 0xFF, and 0xFF 0xFF 0xFF never checks out as 0xFF
+static uint8_t journal_check(uint8_t seq, uint8_t mode, uint8_t wheel) {
+  return 0xA5 ^ seq ^ mode ^ wheel;
+}
+
+// find the newest good record and put the blade's color mode and wheel index back the way they
+// were; returns false if there are no good records
+bool journal_restore() {
+  uint16_t addr = JOURNAL_ADDR;
+  uint8_t i, seq, mode, wheel;
+  bool found = false;
+
+  for (i = 0; i < JOURNAL_RECORDS; i++, addr += JOURNAL_RECORD_LEN) {
+    seq = EEPROM.read(addr);
+    mode = EEPROM.read(addr + 1);
+    wheel = EEPROM.read(addr + 2);
+    if (EEPROM.read(addr + 3) != journal_check(seq, mode, wheel) || mode > COLOR_MODE_WHEEL_HOLD_WHITE) {
+      continue;
+    }
+
+    // the good records were written one after another, so their sequence numbers are all within
+    // JOURNAL_RECORDS of each other; a record is newer if its number is less than halfway around ahead
+    if (!found || (uint8_t)(seq - journal_seq) < 0x80) {
+      found = true;
+      journal_seq = seq;
+      journal_next = (i + 1) % JOURNAL_RECORDS;
+      saved_mode = mode;
+      saved_wheel = wheel;
+    }
+  }
+
+  if (found) {
+    blade.color_mode = (blade_color_mode_t)saved_mode;
+    blade.wheel_index = saved_wheel;
+  }
+  return found;
+}
+
+// append a record if the color mode, or the wheel index in a hold mode, changed since the last one
+void journal_save() {
+  uint8_t wheel = blade.wheel_index;
+  uint16_t addr;
+
+  if (blade.color_mode != COLOR_MODE_WHEEL_HOLD && blade.color_mode != COLOR_MODE_WHEEL_HOLD_WHITE && saved_mode != 0xFF) {
+    wheel = saved_wheel;
+  }
+  if (blade.color_mode == saved_mode && wheel == saved_wheel) {
+    return;
+  }
+
+  saved_mode = blade.color_mode;
+  saved_wheel = wheel;
+  journal_seq++;
+  addr = JOURNAL_ADDR + journal_next * JOURNAL_RECORD_LEN;
+  journal_next = (journal_next + 1) % JOURNAL_RECORDS;
+
+  // the check byte goes last, so a record cut short by a loss of power is very unlikely to check out
+  EEPROM.update(addr, journal_seq);
+  EEPROM.update(addr + 1, saved_mode);
+  EEPROM.update(addr + 2, saved_wheel);
+  EEPROM.update(addr + 3, journal_check(journal_seq, saved_mode, saved_wheel));
+}
+
+#endif
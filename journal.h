@@ -0,0 +1,38 @@
+/* journal.h
+ * Keep the color mode and color wheel position in EEPROM.
+ *
+ * a color locked in with COLOR_MODE_WHEEL_HOLD survives a reset (see snapshot.h), but not the
+ * blade being pulled from the hilt. with REMEMBER_COLOR, the color mode and wheel position are
+ * also written to EEPROM and read back at boot.
+ *
+ * EEPROM cells wear out after about 100,000 writes, so rather than rewrite the same bytes each
+ * time, every save appends a record to a journal of JOURNAL_RECORDS records at the end of the
+ * EEPROM, wrapping around to the start of it when it's full. each cell is written once every
+ * JOURNAL_RECORDS saves. every record has a sequence number one more than the one before it, and a
+ * check byte; the newest good record is the one whose sequence number is furthest ahead. finding
+ * it means reading every record once, so the time it takes at boot is fixed.
+ *
+ * saves only happen when the blade turns off, and only if something changed since the last one.
+ * the LEDs are dark by then, so the few ms a write takes never hold up an animation. the wheel
+ * position only counts as a change in a hold mode; in a cycle mode it's always moving.
+ *
+ * only AVR boards have an EEPROM; on the host build (see extras/host) it's simulated.
+ */
+#pragma once
+
+#include "hardware.h"
+
+#ifdef REMEMBER_COLOR
+  #if !defined(ARDUINO_ARCH_AVR) && !defined(ARDUINO_ARCH_MEGAAVR) && !defined(HOST_BUILD)
+    #error "REMEMBER_COLOR needs an EEPROM; only AVR boards have one"
+  #endif
+
+  #ifndef JOURNAL_RECORDS
+    #define JOURNAL_RECORDS     16      // records in the journal; less than 128
+  #endif
+  #define JOURNAL_RECORD_LEN    4       // sequence number, color mode, wheel index, check
+  #define JOURNAL_LEN           (JOURNAL_RECORDS * JOURNAL_RECORD_LEN)  // bytes at the end of the EEPROM the journal takes
+
+  bool journal_restore();
+  void journal_save();
+#endif
@@ -0,0 +1,13 @@
+/* lut.h
+ * Repetition macros for building lookup tables at compile time.
+ *
+ * C++11 can't fill an array with a loop at compile time, but every element of an initializer
+ * list can be a call to a constexpr function. LUT_256(f, a) writes out f(0, a), f(1, a) ...
+ * f(255, a) so a whole table can be initialized from one function of the index.
+ */
+#pragma once
+
+#define LUT_4(f, a, i)      f((i), a), f((i) + 1, a), f((i) + 2, a), f((i) + 3, a)
+#define LUT_16(f, a, i)     LUT_4(f, a, i), LUT_4(f, a, (i) + 4), LUT_4(f, a, (i) + 8), LUT_4(f, a, (i) + 12)
+#define LUT_64(f, a, i)     LUT_16(f, a, i), LUT_16(f, a, (i) + 16), LUT_16(f, a, (i) + 32), LUT_16(f, a, (i) + 48)
+#define LUT_256(f, a)       LUT_64(f, a, 0), LUT_64(f, a, 64), LUT_64(f, a, 128), LUT_64(f, a, 192)
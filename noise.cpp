@@ -0,0 +1,81 @@
+/* noise.cpp
+ */
+#include "noise.h"
+#include "blade_geometry.h"
+
+#ifdef UNSTABLE_BLADE
+
+// crackle; carries on from one frame to the next
+static uint16_t noise_rng = 0xACE1;
+
+// xorshift with shifts 7, 9, 8; goes through every 16 bit value but 0 before repeating
+static inline uint16_t noise_xorshift(uint16_t x) {
+  x ^= x << 7;
+  x ^= x >> 9;
+  x ^= x << 8;
+  return x;
+}
+
+// a random value for the value noise point p at time step t; the same p and t always give the
+// same value. xorshift on its own just mixes bits around, so the add between the two rounds is
+// there to keep neighbouring points and times from coming out related
+static uint8_t noise_hash(uint8_t p, uint16_t t) {
+  uint16_t x;
+
+  x = noise_xorshift(((uint16_t)p << 8) ^ t ^ 0x9E37);
+  x = noise_xorshift(x + t);
+  return x >> 8;
+}
+
+// the value of noise point p, tf/256 of the way from time step t to t + 1
+static uint8_t noise_point(uint8_t p, uint16_t t, uint8_t tf) {
+  uint8_t a = noise_hash(p, t);
+  uint8_t b = noise_hash(p, t + 1);
+
+  return a + (((int16_t)b - a) * tf >> 8);
+}
+
+// draw one frame of an unstable blade of the given color
+void noise_frame(LED_RGB_TYPE color) {
+  uint32_t now = millis();
+  uint16_t t = now >> NOISE_PERIOD_SHIFT;
+  uint8_t tf = (now & (NOISE_PERIOD - 1)) << (8 - NOISE_PERIOD_SHIFT);
+  uint8_t r = LED_RGB_R(color);
+  uint8_t g = LED_RGB_G(color);
+  uint8_t b = LED_RGB_B(color);
+  uint8_t p = 0;
+  uint8_t from, to;
+  uint16_t i = 0, end;
+  uint16_t v, level;
+  int16_t step;
+  LED_RGB_TYPE c;
+
+  to = noise_point(p, t, tf);
+  while (i < TARGET_MAX) {
+
+    // from one value noise point to the next, the value changes by the same step every pixel;
+    // v is kept with NOISE_CELL_SHIFT bits of fraction so it lands exactly on the next point
+    from = to;
+    to = noise_point(++p, t, tf);
+    v = (uint16_t)from << NOISE_CELL_SHIFT;
+    step = (int16_t)to - from;
+
+    end = i + NOISE_CELL;
+    if (end > TARGET_MAX) {
+      end = TARGET_MAX;
+    }
+
+    for (; i < end; i++) {
+      noise_rng = noise_xorshift(noise_rng);
+
+      // how much of the color to keep, out of 256
+      level = 256 - (v >> (NOISE_CELL_SHIFT + NOISE_DEPTH_SHIFT)) - (noise_rng & NOISE_CRACKLE_MASK);
+      c = LED_RGB((r * level) >> 8, (g * level) >> 8, (b * level) >> 8);
+
+      Blade::set(i, c);
+      v += step;
+    }
+  }
+}
+
+#endif
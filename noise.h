@@ -0,0 +1,33 @@
+/* noise.h
+ * Per-pixel noise for unstable blades.
+ *
+ * an unstable blade (Kylo Ren's, for one) doesn't glow evenly; patches of it dim and brighten,
+ * and it crackles. noise_frame() draws one frame of that by taking the blade color down a little
+ * at each pixel, by an amount made of two parts:
+ *
+ *   value noise    random values at every NOISE_CELL pixels along the blade, and every
+ *                  NOISE_PERIOD ms in time, blended smoothly between in both. these are the
+ *                  slow moving patches.
+ *   crackle        a fresh random amount at every pixel, every frame.
+ *
+ * all of it is integer math with no division. the random values come from xorshift, which is a
+ * handful of shifts and exclusive ors. blending in time takes one multiply per NOISE_CELL pixels;
+ * blending along the blade is a running sum, so it costs an add per pixel. most of the per-pixel
+ * cost is scaling the three color channels and handing the pixel to the LED library.
+ *
+ * extras/host/noise.sh times a frame for several strip lengths.
+ */
+#pragma once
+
+#include "hardware.h"
+
+#ifdef UNSTABLE_BLADE
+  #define NOISE_CELL_SHIFT    3                           // value noise points are 2^n pixels apart
+  #define NOISE_CELL          (1 << NOISE_CELL_SHIFT)
+  #define NOISE_PERIOD_SHIFT  5                           // and 2^n ms apart in time
+  #define NOISE_PERIOD        (1 << NOISE_PERIOD_SHIFT)
+  #define NOISE_DEPTH_SHIFT   1                           // value noise dims a pixel by up to 255 >> n
+  #define NOISE_CRACKLE_MASK  0x1F                        // crackle dims a pixel by up to this much
+
+  void noise_frame(LED_RGB_TYPE color);
+#endif
@@ -0,0 +1,60 @@
+/* pattern.cpp
+ */
+#include "pattern.h"
+#include "telemetry.h"
+#include "bench.h"
+
+#ifdef COMMAND_PATTERNS
+
+// when each command arrived; millis(), truncated to 16 bits, as the patterns only look back a
+// second or so. the runs below say what the commands were, so they aren't kept
+static uint16_t pattern_ring[PATTERN_RING_LEN];
+static uint8_t pattern_head = 0;      // where the next command goes
+static uint8_t clash_run = 0;         // clashes in a row, each within PATTERN_LOCKUP_GAP ms of the last
+static uint8_t flicker_run = 0;       // flicker commands since the last command that wasn't one
+static uint16_t last_clash;
+
+// is this a clash or a flicker command; see blade_process_command()
+#define PATTERN_IS_CLASH(c)     (((c) & 0xE0) == 0xC0)
+#define PATTERN_IS_FLICKER(c)   (((c) & 0xE0) == 0x60)
+
+// the time of the command n commands before the newest one
+#define PATTERN_BACK(n)         pattern_ring[(pattern_head - 1 - (n)) & (PATTERN_RING_LEN - 1)]
+
+// note a command from the hilt; returns the pattern it completes, if it's a clash, or PATTERN_NONE
+uint8_t pattern_command(uint8_t cmd) {
+  uint16_t now = millis();
+  uint8_t pattern = PATTERN_NONE;
+
+  // refreshes arrive every second or so whatever the blade is doing; they'd only break up the runs
+  if ((cmd & 0xE0) == 0xA0) {
+    return PATTERN_NONE;
+  }
+
+  if (PATTERN_IS_CLASH(cmd)) {
+    clash_run = (clash_run > 0 && (uint16_t)(now - last_clash) < PATTERN_LOCKUP_GAP && clash_run < 0xFF) ? clash_run + 1 : 1;
+
+    // the flicker commands leading up to this clash are still the newest in the ring
+    if (flicker_run >= PATTERN_DRAG_FLICKERS && (uint16_t)(now - PATTERN_BACK(PATTERN_DRAG_FLICKERS - 1)) < PATTERN_DRAG_WINDOW) {
+      pattern = PATTERN_DRAG;
+    } else if (clash_run >= 3) {
+      pattern = PATTERN_LOCKUP;
+    } else if (clash_run == 2 && (uint16_t)(now - last_clash) < PATTERN_BLASTER_GAP) {
+      pattern = PATTERN_BLASTER;
+    }
+    last_clash = now;
+  }
+
+  flicker_run = PATTERN_IS_FLICKER(cmd) ? ((flicker_run < 0xFF) ? flicker_run + 1 : flicker_run) : 0;
+
+  pattern_ring[pattern_head] = now;
+  pattern_head = (pattern_head + 1) & (PATTERN_RING_LEN - 1);
+
+  if (pattern != PATTERN_NONE) {
+    BENCH_MARK(BENCH_PATTERN | pattern);
+    DEBUG_EVENT(TELEMETRY_PATTERN, pattern);
+  }
+  return pattern;
+}
+
+#endif
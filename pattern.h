@@ -0,0 +1,42 @@
+/* pattern.h
+ * Lockup, drag, and blaster deflects recognized from the commands the hilt sends.
+ *
+ * the hilt only ever tells the blade to clash or flicker, but how those commands arrive says a bit
+ * more about what the blade is doing. with COMMAND_PATTERNS, the time every command arrived is
+ * kept in a small ring, and each clash is checked against a few patterns:
+ *
+ *   blaster   the second of two clashes less than PATTERN_BLASTER_GAP ms apart; a quick double tap
+ *   lockup    the third (or later) clash in a row, each less than PATTERN_LOCKUP_GAP ms after the
+ *             one before; the blade is held against something
+ *   drag      a clash right after PATTERN_DRAG_FLICKERS flicker commands in a row, all of them in
+ *             the last PATTERN_DRAG_WINDOW ms; the blade is moving steadily while it hits
+ *
+ * blade.cpp draws each as a different kind of clash flash (see clash.h).
+ *
+ * the checks keep running counts and look back a fixed number of places in the ring rather than
+ * searching it, so every command costs the same no matter what's in the ring. this all happens in
+ * blade_process_command(), after the command has been decoded, never while one is being read.
+ */
+#pragma once
+
+#include "hardware.h"
+
+#ifdef COMMAND_PATTERNS
+  #ifndef CLASH_FLASH
+    #error "COMMAND_PATTERNS needs CLASH_FLASH"
+  #endif
+
+  #define PATTERN_RING_LEN        8       // commands remembered; must be a power of 2
+  #define PATTERN_BLASTER_GAP     120     // ms
+  #define PATTERN_LOCKUP_GAP      250     // ms
+  #define PATTERN_DRAG_FLICKERS   4       // must be less than PATTERN_RING_LEN
+  #define PATTERN_DRAG_WINDOW     400     // ms
+
+  // patterns; keep these in sync with extras/telemetry/telemetry_decode.py
+  #define PATTERN_NONE            0
+  #define PATTERN_BLASTER         1
+  #define PATTERN_LOCKUP          2
+  #define PATTERN_DRAG            3
+
+  uint8_t pattern_command(uint8_t cmd);
+#endif
@@ -0,0 +1,75 @@
+/* power.cpp
+ *
+ * WS2812B current draw is roughly linear with the PWM duty cycle of each color channel.
+ * a single channel at full duty draws about LED_CHANNEL_MA and every pixel draws about
+ * LED_IDLE_MA even when dark. so the current for a frame can be estimated as:
+ *
+ *   (NUM_LEDS * LED_IDLE_MA) + (sum of all channel values) * brightness * LED_CHANNEL_MA / (255 * 255)
+ *
+ * MAX_BRIGHTNESS has to be chosen for the worst case, an all-white blade. a red or blue
+ * blade only lights one channel per pixel and can run much brighter on the same battery.
+ * with the governor enabled MAX_BRIGHTNESS can be raised and the brightness will only be
+ * pulled back for frames that would otherwise go over budget.
+ */
+#include "power.h"
+#include "config.h"
+#include "telemetry.h"
+
+#ifdef POWER_BUDGET_MA
+
+// running sum of each color channel across the entire strip
+//
+// the sums are signed so a span removed with the wrong 'from' color (say, a clash arriving
+// in the middle of an ignition) can't wrap around; they are clamped to 0 when read.
+static int32_t power_sum = 0;
+
+// all the LEDs have been turned off
+void power_clear() {
+  power_sum = 0;
+}
+
+// the entire strip has been filled with one color
+void power_fill(LED_RGB_TYPE color) {
+  power_sum = (int32_t)NUM_LEDS * (LED_RGB_R(color) + LED_RGB_G(color) + LED_RGB_B(color));
+}
+
+// n pixels have gone from one color to another
+void power_span(LED_RGB_TYPE from, LED_RGB_TYPE to, uint16_t n) {
+  power_sum += (int32_t)n * ((int16_t)(LED_RGB_R(to) + LED_RGB_G(to) + LED_RGB_B(to)) - (int16_t)(LED_RGB_R(from) + LED_RGB_G(from) + LED_RGB_B(from)));
+}
+
+// estimated current draw, in mA, of the strip as it's currently filled at the given brightness
+uint16_t power_estimate(uint8_t brightness) {
+  uint32_t sum = (power_sum > 0) ? power_sum : 0;
+  return (uint16_t)((sum * brightness * LED_CHANNEL_MA) / (255UL * 255UL)) + (NUM_LEDS * LED_IDLE_MA);
+}
+
+// return the brightness to use for the next frame; this is the requested brightness
+// unless that would put the strip over POWER_BUDGET_MA
+uint8_t power_brightness(uint8_t brightness) {
+  static int32_t last_sum = -1;
+  static uint8_t limit = 255;
+  uint32_t budget;
+
+  // the limit only changes when the contents of the strip change; that's once per fill at most
+  if (power_sum != last_sum) {
+    last_sum = power_sum;
+
+    // how much current is left over for the LEDs once the idle draw of every pixel is paid for
+    budget = (POWER_BUDGET_MA > (NUM_LEDS * LED_IDLE_MA)) ? (POWER_BUDGET_MA - (NUM_LEDS * LED_IDLE_MA)) : 0;
+
+    // solve the estimate for brightness
+    if (power_sum <= 0) {
+      limit = 255;
+    } else {
+      budget = (budget * 255UL * 255UL) / ((uint32_t)power_sum * LED_CHANNEL_MA);
+      limit = (budget > 255) ? 255 : budget;
+    }
+
+    DEBUG_EVENT(TELEMETRY_POWER_LIMIT, limit);
+  }
+
+  return (brightness > limit) ? limit : brightness;
+}
+
+#endif
@@ -0,0 +1,31 @@
+/* power.h
+ * Estimate how much current the LED strip will draw and, if needed, lower the
+ * brightness of the blade to keep that current under POWER_BUDGET_MA.
+ *
+ * rather than scanning every pixel before each call to show(), a running sum of
+ * each color channel is kept and updated by blade_manager() as it fills spans of
+ * the strip with a color. the estimate is then just a few multiplies.
+ *
+ * if POWER_BUDGET_MA is not defined then all of this compiles away to nothing.
+ */
+#pragma once
+
+#include "hardware.h"
+
+#ifdef POWER_BUDGET_MA
+  void power_clear();
+  void power_fill(LED_RGB_TYPE color);
+  void power_span(LED_RGB_TYPE from, LED_RGB_TYPE to, uint16_t n);
+  uint16_t power_estimate(uint8_t brightness);
+  uint8_t power_brightness(uint8_t brightness);
+
+  #define POWER_CLEAR()             power_clear()               // all pixels have been turned off
+  #define POWER_FILL(c)             power_fill(c)               // all pixels have been set to color c
+  #define POWER_SPAN(from, to, n)   power_span(from, to, n)     // n pixels have changed from color 'from' to color 'to'
+  #define POWER_BRIGHTNESS(b)       power_brightness(b)         // the highest brightness, up to b, the budget allows
+#else
+  #define POWER_CLEAR()
+  #define POWER_FILL(c)
+  #define POWER_SPAN(from, to, n)
+  #define POWER_BRIGHTNESS(b)       (b)
+#endif
@@ -0,0 +1,151 @@
+/* profile.cpp
+ */
+#include "profile.h"
+#include "curve.h"
+#include "telemetry.h"
+
+#include "journal.h"
+
+#ifdef USER_PROFILES
+#include <EEPROM.h>
+
+#define PROFILE_HEADER_LEN  3
+
+// with REMEMBER_COLOR the journal has the end of the EEPROM; an image running into it would have
+// its CRC broken by the next journal save
+#ifdef REMEMBER_COLOR
+  #define PROFILE_EEPROM_END  (EEPROM.length() - JOURNAL_LEN)
+#else
+  #define PROFILE_EEPROM_END  EEPROM.length()
+#endif
+
+// the largest image the blade keeps all of has to fit; E2END is the last EEPROM address
+#ifdef E2END
+  #ifdef REMEMBER_COLOR
+    #if PROFILE_EEPROM_ADDR + PROFILE_HEADER_LEN + PROFILE_MAX * PROFILE_RECORD_LEN + 2 > E2END + 1 - JOURNAL_LEN
+      #error "profiles run into the REMEMBER_COLOR journal; lower PROFILE_MAX or JOURNAL_RECORDS, or move PROFILE_EEPROM_ADDR"
+    #endif
+  #elif PROFILE_EEPROM_ADDR + PROFILE_HEADER_LEN + PROFILE_MAX * PROFILE_RECORD_LEN + 2 > E2END + 1
+    #error "profiles don't fit in the EEPROM; lower PROFILE_MAX or move PROFILE_EEPROM_ADDR"
+  #endif
+#endif
+
+typedef struct {
+  stock_lightsaber_t lightsaber;      // stock settings with the profile's laid over them
+  LED_RGB_TYPE color;
+  LED_RGB_TYPE clash;
+} profile_t;
+
+static profile_t profiles[PROFILE_MAX];
+
+// two lightsabers per byte; savi n in the low nibble of byte n, legacy n in the high nibble
+static uint8_t profile_map[LIGHTSABER_TABLE_LEN];
+
+static uint16_t profile_crc(uint16_t crc, uint8_t b) {
+  crc ^= (uint16_t)b << 8;
+  for (uint8_t i = 0; i < 8; i++) {
+    crc = (crc & 0x8000) ? ((crc << 1) ^ 0x1021) : (crc << 1);
+  }
+  return crc;
+}
+
+static uint16_t profile_read_word(uint16_t addr) {
+  return EEPROM.read(addr) | (EEPROM.read(addr + 1) << 8);
+}
+
+// a time longer than TIME_MAX would wrap around to a short one in a SPACE_SAVER build; hold it there
+static blade_timing_t profile_read_time(uint16_t addr) {
+  uint16_t t = profile_read_word(addr);
+
+  return TIME_ENCODE((t > TIME_MAX) ? TIME_MAX : t);
+}
+
+// read the profiles out of EEPROM into RAM; called once at boot. a lightsaber without a good
+// profile uses its stock settings.
+void profile_load() {
+  uint16_t addr = PROFILE_EEPROM_ADDR;
+  uint16_t end, crc = 0xFFFF;
+  uint8_t count, kept = 0, i, n;
+  profile_t *p;
+
+  memset(profile_map, (PROFILE_NONE << 4) | PROFILE_NONE, sizeof(profile_map));
+
+  // check the header and the CRC before trusting any of it; an erased EEPROM reads 0xFF
+  if (EEPROM.read(addr) != PROFILE_MAGIC || EEPROM.read(addr + 1) != PROFILE_VERSION) {
+    return;
+  }
+  count = EEPROM.read(addr + 2);
+  end = addr + PROFILE_HEADER_LEN + (uint16_t)count * PROFILE_RECORD_LEN;
+  if (end + 2 > PROFILE_EEPROM_END) {
+    return;
+  }
+  for (; addr < end; addr++) {
+    crc = profile_crc(crc, EEPROM.read(addr));
+  }
+  if (crc != profile_read_word(end)) {
+    DEBUG_EVENT(TELEMETRY_PROFILES, 0xFF);
+    return;
+  }
+
+  for (addr = PROFILE_EEPROM_ADDR + PROFILE_HEADER_LEN; addr < end && kept < PROFILE_MAX; addr += PROFILE_RECORD_LEN) {
+    n = EEPROM.read(addr);
+    if (n >= PROFILE_LEGACY + LIGHTSABER_TABLE_LEN) {
+      continue;
+    }
+
+    // start from the stock settings so anything a profile can't change (the ignition clip) is kept
+    p = &profiles[kept];
+    p->lightsaber = (n & PROFILE_LEGACY) ? legacy_lightsaber[n & 0x0F] : savi_lightsaber[n & 0x0F];
+    p->color = LED_RGB(EEPROM.read(addr + 1), EEPROM.read(addr + 2), EEPROM.read(addr + 3));
+    p->clash = LED_RGB(EEPROM.read(addr + 4), EEPROM.read(addr + 5), EEPROM.read(addr + 6));
+    p->lightsaber.ignition_time = profile_read_time(addr + 7);
+    p->lightsaber.extinguish_time_delay = profile_read_time(addr + 9);
+    p->lightsaber.extinguish_time = profile_read_time(addr + 11);
+    #ifdef UNSTABLE_BLADE
+      p->lightsaber.effect = EEPROM.read(addr + 13);
+    #endif
+    #ifdef IGNITION_CURVES
+      p->lightsaber.ignition_curve = EEPROM.read(addr + 14);
+      p->lightsaber.extinguish_curve = EEPROM.read(addr + 15);
+      if (p->lightsaber.ignition_curve >= CURVE_COUNT) {
+        p->lightsaber.ignition_curve = CURVE_LINEAR;
+      }
+      if (p->lightsaber.extinguish_curve >= CURVE_COUNT) {
+        p->lightsaber.extinguish_curve = CURVE_LINEAR;
+      }
+    #endif
+
+    // a second profile for the same lightsaber replaces the first
+    i = n & 0x0F;
+    if (n & PROFILE_LEGACY) {
+      profile_map[i] = (profile_map[i] & 0x0F) | (kept << 4);
+    } else {
+      profile_map[i] = (profile_map[i] & 0xF0) | kept;
+    }
+    kept++;
+  }
+  DEBUG_EVENT(TELEMETRY_PROFILES, kept);
+}
+
+// the slot of the profile replacing a lightsaber, or PROFILE_NONE; n is its index in the savi or
+// legacy table, plus PROFILE_LEGACY for a legacy one
+uint8_t profile_slot(uint8_t n) {
+  return (n & PROFILE_LEGACY) ? (profile_map[n & 0x0F] >> 4) : (profile_map[n & 0x0F] & 0x0F);
+}
+
+// the settings of the profile in slot; slot must not be PROFILE_NONE
+const stock_lightsaber_t *profile_settings(uint8_t slot) {
+  return &profiles[slot].lightsaber;
+}
+
+// if there's a profile in slot, get its colors and return true
+bool profile_colors(uint8_t slot, LED_RGB_TYPE *color, LED_RGB_TYPE *clash) {
+  if (slot == PROFILE_NONE) {
+    return false;
+  }
+  *color = profiles[slot].color;
+  *clash = profiles[slot].clash;
+  return true;
+}
+
+#endif
@@ -0,0 +1,69 @@
+/* profile.h
+ * User profiles; stock lightsaber settings overridden from EEPROM.
+ *
+ * the savi and legacy lightsaber tables in stock_blade_config.cpp are compiled in, and a few of the
+ * savi entries are only guesses. with USER_PROFILES, any entry in either table can be replaced by a
+ * profile stored in the MCU's EEPROM, giving it its own blade and clash colors, timings, effect and
+ * curves. extras/profiles/profile_encode.py writes the EEPROM image.
+ *
+ * the profiles are read, and checked, once at boot. those that are good are kept in a small cache
+ * in RAM, with a 4-bit slot number for each of the 32 lightsabers saying which cached profile, if
+ * any, replaces it. finding the settings for a lightsaber is a lookup in that map either way; the
+ * EEPROM is never read again. if there's no EEPROM image, or it fails its checks, every lightsaber
+ * uses its stock settings.
+ *
+ * EEPROM LAYOUT (from PROFILE_EEPROM_ADDR, multi-byte values little endian)
+ *   u8      PROFILE_MAGIC
+ *   u8      PROFILE_VERSION; an image written for any other version is ignored
+ *   u8      number of profiles that follow
+ *   then, for each profile, PROFILE_RECORD_LEN bytes:
+ *     u8    lightsaber; its index in the savi or legacy table, plus PROFILE_LEGACY for a legacy one
+ *     u8x3  blade color; red, green, blue
+ *     u8x3  clash color
+ *     u16   ignition time, ms; held to TIME_MAX (1020 with SPACE_SAVER)
+ *     u16   extinguish time delay, ms; likewise
+ *     u16   extinguish time, ms; likewise
+ *     u8    effect (see effects.h)
+ *     u8    ignition curve (see curve.h)
+ *     u8    extinguish curve
+ *   u16     CRC-16/CCITT (polynomial 0x1021, starting from 0xFFFF) of everything above
+ *
+ * only the first PROFILE_MAX profiles are kept. a profile can't change a lightsaber's ignition clip,
+ * and its effect and curves are skipped over in a build without UNSTABLE_BLADE or IGNITION_CURVES.
+ *
+ * with REMEMBER_COLOR, the journal (see journal.h) has the last JOURNAL_LEN bytes of the EEPROM and
+ * an image reaching into them is ignored. an image of PROFILE_MAX profiles has to fit in front of
+ * it; on a 128 byte EEPROM with the default 16 record journal that's 3, not the default 4.
+ *
+ * only AVR boards have an EEPROM; on the host build (see extras/host) it's simulated.
+ */
+#pragma once
+
+#include "hardware.h"
+#include "stock_blade_config.h"
+
+#ifdef USER_PROFILES
+  #if !defined(ARDUINO_ARCH_AVR) && !defined(ARDUINO_ARCH_MEGAAVR) && !defined(HOST_BUILD)
+    #error "USER_PROFILES needs an EEPROM; only AVR boards have one"
+  #endif
+
+  #ifndef PROFILE_MAX
+    #define PROFILE_MAX         4       // profiles kept in RAM; at most 15
+  #endif
+  #if PROFILE_MAX > 15
+    #error "PROFILE_MAX can be at most 15"
+  #endif
+  #ifndef PROFILE_EEPROM_ADDR
+    #define PROFILE_EEPROM_ADDR 0
+  #endif
+  #define PROFILE_MAGIC         0xB7
+  #define PROFILE_VERSION       1
+  #define PROFILE_RECORD_LEN    16
+  #define PROFILE_LEGACY        LIGHTSABER_LEGACY   // added to the lightsaber number of a legacy lightsaber
+  #define PROFILE_NONE          0x0F                // no profile; the lightsaber uses its stock settings
+
+  void profile_load();
+  uint8_t profile_slot(uint8_t lightsaber);
+  const stock_lightsaber_t *profile_settings(uint8_t slot);
+  bool profile_colors(uint8_t slot, LED_RGB_TYPE *color, LED_RGB_TYPE *clash);
+#endif
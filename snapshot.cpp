@@ -0,0 +1,70 @@
+/* snapshot.cpp
+ *
+ * the snapshot is a handful of bytes guarded by a magic number and a checksum. after a true
+ * power-on, RAM holds random values, so both have to match before the snapshot is trusted.
+ */
+#include "snapshot.h"
+#include "blade.h"
+
+#ifdef BLADE_SNAPSHOT
+
+#define SNAPSHOT_MAGIC      0xB1AD
+
+typedef struct {
+  uint16_t magic;
+  uint8_t lightsaber;                 // blade.number; see LIGHTSABER_LEGACY
+  uint8_t color_mode;
+  uint8_t wheel_index;
+  uint8_t lit;                        // non-zero if the blade was on
+  uint8_t check;
+} blade_snapshot_t;
+
+static blade_snapshot_t snapshot __attribute__((section(".noinit")));
+
+// a simple checksum over everything but the checksum itself
+static uint8_t snapshot_check() {
+  return 0x5A ^ snapshot.lightsaber ^ snapshot.color_mode ^ snapshot.wheel_index ^ snapshot.lit ^ (uint8_t)(snapshot.magic >> 8) ^ (uint8_t)snapshot.magic;
+}
+
+// copy the blade's state into the snapshot
+void snapshot_save() {
+  snapshot.lightsaber = blade.number;
+  snapshot.color_mode = blade.color_mode;
+  snapshot.wheel_index = blade.wheel_index;
+
+  switch (blade.state) {
+    case BLADE_UNINITIALIZED:
+    case BLADE_OFF:
+    case BLADE_EXTINGUISHING:
+      snapshot.lit = 0;
+      break;
+    default:
+      snapshot.lit = 1;
+      break;
+  }
+  snapshot.magic = SNAPSHOT_MAGIC;
+  snapshot.check = snapshot_check();
+}
+
+// restore the blade's state from the snapshot. returns true if a valid snapshot was found.
+//
+// if the blade was lit it is put in BLADE_REFRESH so blade_manager() lights it on its first pass.
+bool snapshot_restore() {
+  bool valid = (snapshot.magic == SNAPSHOT_MAGIC && snapshot.check == snapshot_check() && snapshot.color_mode <= COLOR_MODE_WHEEL_HOLD_WHITE &&
+               snapshot.lightsaber < LIGHTSABER_LEGACY + LIGHTSABER_TABLE_LEN);
+
+  if (valid) {
+    blade_set_lightsaber(snapshot.lightsaber);
+    blade.color_mode = (blade_color_mode_t)snapshot.color_mode;
+    blade.wheel_index = snapshot.wheel_index;
+    if (snapshot.lit) {
+      blade.state = BLADE_REFRESH;
+    }
+  }
+
+  // invalidate until the next save so a stale snapshot is never used twice
+  snapshot.magic = 0;
+  return valid;
+}
+
+#endif
@@ -0,0 +1,23 @@
+/* snapshot.h
+ * Keep a copy of the blade's state in RAM that is not cleared on reset.
+ *
+ * blades wiggle in their sockets and the blade controller can lose power for just long
+ * enough to reset. RAM survives a brief brownout or reset, but the C runtime clears it at
+ * startup; variables placed in the .noinit section are left alone. with a copy of the blade
+ * state there, a blade that was lit can come straight back on without waiting up to a second
+ * for the hilt's next refresh, and a custom color locked in with COLOR_MODE_WHEEL_HOLD is kept.
+ *
+ * only AVR cores are known to provide a .noinit section; on other boards this is disabled.
+ */
+#pragma once
+
+#include "hardware.h"
+
+#if defined(ARDUINO_ARCH_AVR) || defined(ARDUINO_ARCH_MEGAAVR)
+  #define BLADE_SNAPSHOT
+#endif
+
+#ifdef BLADE_SNAPSHOT
+  void snapshot_save();
+  bool snapshot_restore();
+#endif
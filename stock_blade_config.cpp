@@ -7,50 +7,57 @@
  * and extinguish animation effects to match with what the hilt expects. otherwise
  * the animations may not align with the hilt's sound effects.
  *
+ * the curves only matter with IGNITION_CURVES (see curve.h); they change how the
+ * LEDs are spread over those times, not the times themselves. the ones given to
+ * Darth Vader and Darth Maul are a starting point to tune against the hilt.
+ *
  */
 #include "stock_blade_config.h"
 #include "blade_color_table.h"
+#include "clip_data.h"
+#include "effects.h"
+#include "curve.h"
 
 // savi's workshop lightsaber properties
 // timing values were taken from logic analyzer captures of a stock V2 blade controller
 const stock_lightsaber_t savi_lightsaber[LIGHTSABER_TABLE_LEN] = {
-//  COLOR,                    IGNITION_TIME,    EXTINGUISH_TIME_DELAY,  EXTINGUISH_TIME
-  { INDEX_BLADE_WHITE,        TIME_ENCODE(280), TIME_ENCODE(370),       TIME_ENCODE(470)}, //  white kyber crystal
-  { INDEX_BLADE_RED,          TIME_ENCODE(280), TIME_ENCODE(940),       TIME_ENCODE(470)}, //    red kyber crystal
-  { INDEX_BLADE_ORANGE,       TIME_ENCODE(280), TIME_ENCODE(000),       TIME_ENCODE(275)}, // orange kyber crystal
-  { INDEX_BLADE_YELLOW,       TIME_ENCODE(280), TIME_ENCODE(000),       TIME_ENCODE(275)}, // yellow kyber crystal
-  { INDEX_BLADE_GREEN,        TIME_ENCODE(280), TIME_ENCODE(180),       TIME_ENCODE(470)}, //  green kyber crystal
-  { INDEX_BLADE_CYAN,         TIME_ENCODE(280), TIME_ENCODE(275),       TIME_ENCODE(565)}, //   cyan kyber crystal
-  { INDEX_BLADE_BLUE,         TIME_ENCODE(280), TIME_ENCODE(275),       TIME_ENCODE(565)}, //   blue kyber crystal
-  { INDEX_BLADE_PURPLE,       TIME_ENCODE(280), TIME_ENCODE(370),       TIME_ENCODE(660)}, // purple kyber crystal
-  { INDEX_BLADE_DARK_PURPLE,  TIME_ENCODE(280), TIME_ENCODE(945),       TIME_ENCODE(470)}, // unused; blades bundled with legacy hilts produce ORANGE instead
-  { INDEX_BLADE_RED,          TIME_ENCODE(240), TIME_ENCODE(830),       TIME_ENCODE(415)}, //
-  { INDEX_BLADE_RED,          TIME_ENCODE(240), TIME_ENCODE(830),       TIME_ENCODE(415)}, //
-  { INDEX_BLADE_YELLOW,       TIME_ENCODE(240), TIME_ENCODE(000),       TIME_ENCODE(240)}, //
-  { INDEX_BLADE_GREEN,        TIME_ENCODE(240), TIME_ENCODE(160),       TIME_ENCODE(415)}, //
-  { INDEX_BLADE_RED,          TIME_ENCODE(240), TIME_ENCODE(830),       TIME_ENCODE(415)}, //
-  { INDEX_BLADE_BLUE,         TIME_ENCODE(240), TIME_ENCODE(245),       TIME_ENCODE(500)}, //
-  { INDEX_BLADE_PURPLE,       TIME_ENCODE(240), TIME_ENCODE(330),       TIME_ENCODE(545)}  //
+//  COLOR,                    IGNITION_TIME,    EXTINGUISH_TIME_DELAY,  EXTINGUISH_TIME  IGNITION_CLIP                      EFFECT                              IGNITION_CURVE, EXTINGUISH_CURVE
+  { INDEX_BLADE_WHITE,        TIME_ENCODE(280), TIME_ENCODE(370),       TIME_ENCODE(470) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, //  white kyber crystal
+  { INDEX_BLADE_RED,          TIME_ENCODE(280), TIME_ENCODE(940),       TIME_ENCODE(470) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, //    red kyber crystal
+  { INDEX_BLADE_ORANGE,       TIME_ENCODE(280), TIME_ENCODE(000),       TIME_ENCODE(275) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, // orange kyber crystal
+  { INDEX_BLADE_YELLOW,       TIME_ENCODE(280), TIME_ENCODE(000),       TIME_ENCODE(275) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, // yellow kyber crystal
+  { INDEX_BLADE_GREEN,        TIME_ENCODE(280), TIME_ENCODE(180),       TIME_ENCODE(470) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, //  green kyber crystal
+  { INDEX_BLADE_CYAN,         TIME_ENCODE(280), TIME_ENCODE(275),       TIME_ENCODE(565) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, //   cyan kyber crystal
+  { INDEX_BLADE_BLUE,         TIME_ENCODE(280), TIME_ENCODE(275),       TIME_ENCODE(565) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, //   blue kyber crystal
+  { INDEX_BLADE_PURPLE,       TIME_ENCODE(280), TIME_ENCODE(370),       TIME_ENCODE(660) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, // purple kyber crystal
+  { INDEX_BLADE_DARK_PURPLE,  TIME_ENCODE(280), TIME_ENCODE(945),       TIME_ENCODE(470) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, // unused; blades bundled with legacy hilts produce ORANGE instead
+  { INDEX_BLADE_RED,          TIME_ENCODE(240), TIME_ENCODE(830),       TIME_ENCODE(415) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, //
+  { INDEX_BLADE_RED,          TIME_ENCODE(240), TIME_ENCODE(830),       TIME_ENCODE(415) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, //
+  { INDEX_BLADE_YELLOW,       TIME_ENCODE(240), TIME_ENCODE(000),       TIME_ENCODE(240) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, //
+  { INDEX_BLADE_GREEN,        TIME_ENCODE(240), TIME_ENCODE(160),       TIME_ENCODE(415) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, //
+  { INDEX_BLADE_RED,          TIME_ENCODE(240), TIME_ENCODE(830),       TIME_ENCODE(415) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, //
+  { INDEX_BLADE_BLUE,         TIME_ENCODE(240), TIME_ENCODE(245),       TIME_ENCODE(500) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, //
+  { INDEX_BLADE_PURPLE,       TIME_ENCODE(240), TIME_ENCODE(330),       TIME_ENCODE(545) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }  //
 };
 
 // legacy lightsaber properties
 // timing values were taken from logic analyzer captures of a stock V2 blade controller
 const stock_lightsaber_t legacy_lightsaber[LIGHTSABER_TABLE_LEN] = {
-//  COLOR,                    IGNITION_TIME,    EXTINGUISH_TIME_DELAY,  EXTINGUISH_TIME
-  { INDEX_BLADE_YELLOW,       TIME_ENCODE(240), TIME_ENCODE(000),       TIME_ENCODE(325)}, // Temple Guard
-  { INDEX_BLADE_RED,          TIME_ENCODE(240), TIME_ENCODE(830),       TIME_ENCODE(335)}, // Kylo Ren
-  { INDEX_BLADE_BLUE,         TIME_ENCODE(240), TIME_ENCODE(500),       TIME_ENCODE(415)}, // Rey (Anakin), Rey Reforged, Ahsoka (CW)
-  { INDEX_BLADE_PURPLE,       TIME_ENCODE(240), TIME_ENCODE(490),       TIME_ENCODE(585)}, // Mace Windu
-  { INDEX_BLADE_RED,          TIME_ENCODE(240), TIME_ENCODE(660),       TIME_ENCODE(335)}, // Asajj Ventress
-  { INDEX_BLADE_WHITE,        TIME_ENCODE(240), TIME_ENCODE(160),       TIME_ENCODE(415)}, // Ahsoka (Rebels)
-  { INDEX_BLADE_GREEN,        TIME_ENCODE(240), TIME_ENCODE(160),       TIME_ENCODE(415)}, // Luke
-  { INDEX_BLADE_RED,          TIME_ENCODE(240), TIME_ENCODE(500),       TIME_ENCODE(500)}, // Darth Vader
-  { INDEX_BLADE_RED,          TIME_ENCODE(240), TIME_ENCODE(750),       TIME_ENCODE(330)}, // Darth Maul
-  { INDEX_BLADE_BLUE,         TIME_ENCODE(240), TIME_ENCODE(495),       TIME_ENCODE(415)}, // Obi-Wan, Ben Solo
-  { INDEX_BLADE_ORANGE_RED,   TIME_ENCODE(240), TIME_ENCODE(175),       TIME_ENCODE(450)}, // Baylan Skoll / Shin Hati
-  { INDEX_BLADE_WHITE,        TIME_ENCODE(240), TIME_ENCODE(160),       TIME_ENCODE(415)},
-  { INDEX_BLADE_WHITE,        TIME_ENCODE(240), TIME_ENCODE(160),       TIME_ENCODE(415)},
-  { INDEX_BLADE_WHITE,        TIME_ENCODE(240), TIME_ENCODE(160),       TIME_ENCODE(415)},
-  { INDEX_BLADE_WHITE,        TIME_ENCODE(240), TIME_ENCODE(160),       TIME_ENCODE(415)},
-  { INDEX_BLADE_WHITE,        TIME_ENCODE(240), TIME_ENCODE(160),       TIME_ENCODE(415)}
+//  COLOR,                    IGNITION_TIME,    EXTINGUISH_TIME_DELAY,  EXTINGUISH_TIME  IGNITION_CLIP                      EFFECT                              IGNITION_CURVE, EXTINGUISH_CURVE
+  { INDEX_BLADE_YELLOW,       TIME_ENCODE(240), TIME_ENCODE(000),       TIME_ENCODE(325) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, // Temple Guard
+  { INDEX_BLADE_RED,          TIME_ENCODE(240), TIME_ENCODE(830),       TIME_ENCODE(335) LIGHTSABER_CLIP(CLIP_KYLO_IGNITE)  LIGHTSABER_EFFECT(EFFECT_UNSTABLE)  LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, // Kylo Ren
+  { INDEX_BLADE_BLUE,         TIME_ENCODE(240), TIME_ENCODE(500),       TIME_ENCODE(415) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, // Rey (Anakin), Rey Reforged, Ahsoka (CW)
+  { INDEX_BLADE_PURPLE,       TIME_ENCODE(240), TIME_ENCODE(490),       TIME_ENCODE(585) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, // Mace Windu
+  { INDEX_BLADE_RED,          TIME_ENCODE(240), TIME_ENCODE(660),       TIME_ENCODE(335) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, // Asajj Ventress
+  { INDEX_BLADE_WHITE,        TIME_ENCODE(240), TIME_ENCODE(160),       TIME_ENCODE(415) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, // Ahsoka (Rebels)
+  { INDEX_BLADE_GREEN,        TIME_ENCODE(240), TIME_ENCODE(160),       TIME_ENCODE(415) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, // Luke
+  { INDEX_BLADE_RED,          TIME_ENCODE(240), TIME_ENCODE(500),       TIME_ENCODE(500) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_EASE_OUT, CURVE_EASE_IN) }, // Darth Vader
+  { INDEX_BLADE_RED,          TIME_ENCODE(240), TIME_ENCODE(750),       TIME_ENCODE(330) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_EASE_OUT, CURVE_EASE_IN) }, // Darth Maul
+  { INDEX_BLADE_BLUE,         TIME_ENCODE(240), TIME_ENCODE(495),       TIME_ENCODE(415) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, // Obi-Wan, Ben Solo
+  { INDEX_BLADE_ORANGE_RED,   TIME_ENCODE(240), TIME_ENCODE(175),       TIME_ENCODE(450) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }, // Baylan Skoll / Shin Hati
+  { INDEX_BLADE_WHITE,        TIME_ENCODE(240), TIME_ENCODE(160),       TIME_ENCODE(415) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) },
+  { INDEX_BLADE_WHITE,        TIME_ENCODE(240), TIME_ENCODE(160),       TIME_ENCODE(415) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) },
+  { INDEX_BLADE_WHITE,        TIME_ENCODE(240), TIME_ENCODE(160),       TIME_ENCODE(415) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) },
+  { INDEX_BLADE_WHITE,        TIME_ENCODE(240), TIME_ENCODE(160),       TIME_ENCODE(415) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) },
+  { INDEX_BLADE_WHITE,        TIME_ENCODE(240), TIME_ENCODE(160),       TIME_ENCODE(415) LIGHTSABER_CLIP(CLIP_NONE)         LIGHTSABER_EFFECT(EFFECT_NONE)      LIGHTSABER_CURVES(CURVE_LINEAR, CURVE_LINEAR) }
 };
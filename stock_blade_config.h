@@ -9,23 +9,57 @@
 #ifdef SPACE_SAVER
   #define TIME_ENCODE(t)  ( uint8_t)((t & 0x3FF) >> 2)
   #define TIME_DECODE(t)  (uint16_t)(t << 2)
+  #define TIME_MAX        1020        // longest time, in ms, that survives TIME_ENCODE()
   typedef uint8_t blade_timing_t;
 #else
   #define TIME_ENCODE(t)  (uint16_t)t
   #define TIME_DECODE(t)  (uint16_t)t
+  #define TIME_MAX        65535
   typedef uint16_t blade_timing_t;
 #endif
 
 // how many lightsabers per lightsaber table
 #define LIGHTSABER_TABLE_LEN    16
 
+// a lightsaber is numbered by its index in its table, plus this for one in the legacy table
+#define LIGHTSABER_LEGACY       0x10
+
 // stock lightsaber properties template
 typedef struct {
   uint8_t color_index;
   blade_timing_t ignition_time;
   blade_timing_t extinguish_time_delay;
   blade_timing_t extinguish_time;
+  #ifdef ENABLE_CLIPS
+    uint8_t ignition_clip;            // clip played instead of the stock ignition (see clip.h), or CLIP_NONE
+  #endif
+  #ifdef UNSTABLE_BLADE
+    uint8_t effect;                   // brightness effect while the blade is lit (see effects.h), or EFFECT_NONE
+  #endif
+  #ifdef IGNITION_CURVES
+    uint8_t ignition_curve;           // how the ignition is spread over ignition_time (see curve.h)
+    uint8_t extinguish_curve;         // how the extinguish is spread over extinguish_time (see curve.h)
+  #endif
 } stock_lightsaber_t;
 
+// the columns after extinguish_time are only there in a build with the feature that uses them;
+// 32 lightsabers is 128 bytes of flash for all four. the tables in stock_blade_config.cpp give
+// them through these, which drop the value along with the column.
+#ifdef ENABLE_CLIPS
+  #define LIGHTSABER_CLIP(c)          , c
+#else
+  #define LIGHTSABER_CLIP(c)
+#endif
+#ifdef UNSTABLE_BLADE
+  #define LIGHTSABER_EFFECT(e)        , e
+#else
+  #define LIGHTSABER_EFFECT(e)
+#endif
+#ifdef IGNITION_CURVES
+  #define LIGHTSABER_CURVES(i, e)     , i, e
+#else
+  #define LIGHTSABER_CURVES(i, e)
+#endif
+
 extern const stock_lightsaber_t savi_lightsaber[LIGHTSABER_TABLE_LEN];
 extern const stock_lightsaber_t legacy_lightsaber[LIGHTSABER_TABLE_LEN];
\ No newline at end of file
@@ -0,0 +1,108 @@
+/* telemetry.cpp
+ *
+ * each event goes out over serial as a 7 byte frame:
+ *
+ *   0xA5, id, payload low, payload high, time low, time high, checksum
+ *
+ * the checksum is the 8-bit sum of the 5 bytes between the sync byte and the checksum. a
+ * decoder that starts listening part way through a frame, or misses a byte, looks for the next
+ * 0xA5 that is followed by a good checksum.
+ *
+ * the timestamp is millis() truncated to 16 bits, so it wraps roughly every 65 seconds. the
+ * decoder unwraps it assuming events arrive more often than that; a blade sitting idle long
+ * enough to go to sleep will show a jump in time it can't account for. events go out in the order
+ * they were logged, and the overflow and statistics frames are stamped so they fit in between, so
+ * the timestamps sent never go backwards.
+ */
+#include "telemetry.h"
+#include "config.h"
+#include "hilt_cmd.h"
+
+#ifdef SERIAL_DEBUG_ENABLE
+
+telemetry_event_t telemetry_ring[TELEMETRY_RING_LEN];
+uint8_t telemetry_head = 0;
+static uint8_t telemetry_tail = 0;
+static bool telemetry_started = false;
+
+// the next word of cmd_stats to send; 0xFF when no report is in progress
+#ifdef CMD_STATS
+  #define TELEMETRY_STATS_LEN       (sizeof(cmd_stats_t) / sizeof(uint16_t))
+  static uint8_t telemetry_stats_next = 0xFF;
+#endif
+
+// send a single frame; the caller has already checked there is room for it
+static void telemetry_send(uint8_t id, uint16_t payload, uint16_t time) {
+  uint8_t frame[TELEMETRY_FRAME_LEN];
+
+  frame[0] = TELEMETRY_SYNC;
+  frame[1] = id;
+  frame[2] = payload & 0xFF;
+  frame[3] = payload >> 8;
+  frame[4] = time & 0xFF;
+  frame[5] = time >> 8;
+  frame[6] = frame[1] + frame[2] + frame[3] + frame[4] + frame[5];
+
+  Serial.write(frame, TELEMETRY_FRAME_LEN);
+}
+
+// start the serial port; until then events are only logged
+void telemetry_begin() {
+  Serial.begin(115200);
+  telemetry_started = true;
+}
+
+// send as many queued events as will fit in the serial transmit buffer without waiting.
+//
+// this is called from loop() between passes of blade_manager(), so it never runs during
+// SHOW_LEDS(). it also backs off while a command is being read from the hilt; a transmit
+// complete interrupt landing on a hilt data edge would add jitter to the measured bit period.
+void telemetry_drain() {
+  uint8_t lost;
+
+  if (!telemetry_started) {
+    return;
+  }
+
+  #ifdef USE_DONT_SHOW
+    if (dont_show) {
+      return;
+    }
+  #endif
+
+  // the ring has wrapped since the last drain; skip ahead to the oldest event still in it. the
+  // overflow is stamped with that event's time so the timestamps sent never go backwards
+  lost = telemetry_head - telemetry_tail;
+  if (lost > TELEMETRY_RING_LEN) {
+    if (Serial.availableForWrite() < TELEMETRY_FRAME_LEN) {
+      return;
+    }
+    lost -= TELEMETRY_RING_LEN;
+    telemetry_tail += lost;
+    telemetry_send(TELEMETRY_OVERFLOW, lost, telemetry_ring[telemetry_tail & (TELEMETRY_RING_LEN - 1)].time);
+  }
+
+  while (telemetry_tail != telemetry_head && Serial.availableForWrite() >= TELEMETRY_FRAME_LEN) {
+    telemetry_event_t *e = &telemetry_ring[telemetry_tail++ & (TELEMETRY_RING_LEN - 1)];
+    telemetry_send(e->id, e->payload, e->time);
+  }
+
+  // a statistics report goes out once the ring is empty. it is read straight out of cmd_stats,
+  // one word per frame, rather than being copied into the ring which it would overflow.
+  #ifdef CMD_STATS
+    while (telemetry_tail == telemetry_head && telemetry_stats_next < TELEMETRY_STATS_LEN && Serial.availableForWrite() >= TELEMETRY_FRAME_LEN) {
+      telemetry_send(TELEMETRY_CMD_STATS + telemetry_stats_next, ((uint16_t *)&cmd_stats)[telemetry_stats_next], millis());
+      telemetry_stats_next++;
+    }
+  #endif
+}
+
+// start sending the command decoder statistics; the counts sent are the ones current at the time
+// each frame goes out, not at the time of this call
+void telemetry_report_stats() {
+  #ifdef CMD_STATS
+    telemetry_stats_next = 0;
+  #endif
+}
+
+#endif
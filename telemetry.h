@@ -0,0 +1,85 @@
+/* telemetry.h
+ * Binary debug event log.
+ *
+ * with SERIAL_DEBUG_ENABLE defined, debug output is not printed as text where it happens.
+ * instead DEBUG_EVENT() drops a small (timestamp, event id, payload) record into a ring
+ * buffer in RAM, which only takes a few instructions. loop() calls telemetry_drain() and the
+ * records trickle out over serial as framed binary, but only when no command is coming in from
+ * the hilt and only as much as fits in the serial transmit buffer, so nothing ever waits on
+ * the serial port and turning debug on barely changes the timing of the blade.
+ *
+ * nothing is sent until telemetry_begin() has started the serial port, which hardware_deferred_setup()
+ * does once the blade has answered its first command; the events logged at boot wait in the ring.
+ *
+ * extras/telemetry/telemetry_decode.py turns the stream back into readable text.
+ *
+ * if SERIAL_DEBUG_ENABLE is not defined then all of this compiles away to nothing.
+ */
+#pragma once
+
+#include "hardware.h"
+
+// event ids; keep these in sync with extras/telemetry/telemetry_decode.py
+#define TELEMETRY_BOOT              0x01    // payload: time from power up to command capture being armed, in 10us steps; 0xFFFF if 655ms or more
+#define TELEMETRY_READY             0x02    // payload: none; deferred hardware setup is done
+#define TELEMETRY_PROFILES          0x03    // payload: profiles loaded by USER_PROFILES, or 0xFF if the EEPROM image failed its CRC
+#define TELEMETRY_STATE             0x10    // payload: new blade state
+#define TELEMETRY_COLOR_MODE        0x11    // payload: new color mode
+#define TELEMETRY_WHEEL             0x12    // payload: new color wheel index
+#define TELEMETRY_CMD               0x20    // payload: command received from the hilt
+#define TELEMETRY_REFRESH_BLOCKED   0x21    // payload: blade state the refresh was blocked in
+#define TELEMETRY_DEMO_RESTART      0x22    // payload: none; the demo command list is starting over
+#define TELEMETRY_BIT_SPLIT         0x23    // payload: new bit split learned by ADAPTIVE_BIT_SPLIT, in us or TCB0 ticks
+#define TELEMETRY_PATTERN           0x24    // payload: pattern recognized by COMMAND_PATTERNS (see pattern.h)
+#define TELEMETRY_POWER_LIMIT       0x30    // payload: brightness limit set by the power governor
+#define TELEMETRY_BATTERY_MV        0x31    // payload: smoothed battery voltage, in mV
+#define TELEMETRY_BATTERY_RUNTIME   0x32    // payload: estimated runtime left, in minutes
+#define TELEMETRY_EFFECT_ERROR      0x40    // payload: effect class that could not be registered
+#define TELEMETRY_CMD_STATS         0x50    // 0x50 + n; payload: word n of cmd_stats (see hilt_cmd.h)
+#define TELEMETRY_OVERFLOW          0x7F    // payload: number of events lost because the ring was full
+
+// a time in us as a TELEMETRY_BOOT payload; the payload is only 16 bits
+#define TELEMETRY_BOOT_TIME(us)     (((us) < 655350UL) ? (uint16_t)((us) / 10) : 0xFFFF)
+
+#ifdef SERIAL_DEBUG_ENABLE
+
+  // number of events the ring can hold; must be a power of 2 no larger than 128.
+  // each event takes 5 bytes of RAM.
+  #ifndef TELEMETRY_RING_LEN
+    #define TELEMETRY_RING_LEN      16
+  #endif
+
+  #define TELEMETRY_SYNC            0xA5    // first byte of every frame sent over serial
+  #define TELEMETRY_FRAME_LEN       7       // sync, id, payload (2), timestamp (2), checksum
+
+  typedef struct {
+    uint16_t time;      // millis(), truncated to 16 bits
+    uint8_t id;
+    uint16_t payload;
+  } telemetry_event_t;
+
+  extern telemetry_event_t telemetry_ring[TELEMETRY_RING_LEN];
+  extern uint8_t telemetry_head;
+
+  // record an event. the oldest event is overwritten if the ring is full; telemetry_drain()
+  // notices and reports how many were lost. this is only called from loop() context, never
+  // from an ISR, so there is no need to disable interrupts around it.
+  inline void telemetry_log(uint8_t id, uint16_t payload) {
+    telemetry_event_t *e = &telemetry_ring[telemetry_head++ & (TELEMETRY_RING_LEN - 1)];
+    e->time = millis();
+    e->id = id;
+    e->payload = payload;
+  }
+
+  void telemetry_begin();
+  void telemetry_drain();
+  void telemetry_report_stats();
+
+  #define DEBUG_EVENT(id, payload)  telemetry_log(id, payload)
+  #define DEBUG_DRAIN()             telemetry_drain()
+  #define DEBUG_STATS()             telemetry_report_stats()
+#else
+  #define DEBUG_EVENT(id, payload)
+  #define DEBUG_DRAIN()
+  #define DEBUG_STATS()
+#endif